@@ -1,131 +1,1583 @@
 #ifndef BTREE_H
 #define BTREE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <iterator>
-#include <sstream>
+#include <new>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "slist/compare.h"
+#include "slist/format.h"
+
+// target node size: four cache lines
+constexpr std::size_t btree_node_bytes = 256;
+
+// default keys per leaf: leaves carry two sibling links and a small header
+template<class T>
+constexpr std::size_t btree_leaf_capacity()
+{
+	return (btree_node_bytes - 3 * sizeof(void*)) / sizeof(T) > 4 ? (btree_node_bytes - 3 * sizeof(void*)) / sizeof(T) : 4;
+}
+
+// default keys per inner node: every key comes with one child pointer
 template<class T>
+constexpr std::size_t btree_inner_capacity()
+{
+	return (btree_node_bytes - 2 * sizeof(void*)) / (sizeof(T) + sizeof(void*)) > 4
+		? (btree_node_bytes - 2 * sizeof(void*)) / (sizeof(T) + sizeof(void*)) : 4;
+}
+
+// tag for constructors whose input is already sorted with no duplicates
+struct sorted_unique_t
+{
+	explicit sorted_unique_t() = default;
+};
+
+constexpr sorted_unique_t sorted_unique{};
+
+// Ordered set of unique keys, kept as a B+tree. Every key lives in a leaf,
+// leaves hold their keys in one contiguous array and are chained both ways
+// for iteration, and inner nodes hold only separator copies and child
+// pointers. Nodes are sized to a few cache lines, so a lookup over millions
+// of keys touches three or four nodes, each a short run of adjacent keys,
+// instead of one cache miss per level of a binary tree.
+//
+// Inner node i routes keys k with key[i - 1] <= k < key[i] to child[i].
+// Inserts split a full node in two, except that an insert past the largest
+// key leaves the full node whole and starts a new one to its right, so a
+// tree built by appending packs its nodes full. Erases borrow from or merge
+// with a sibling when a node falls under half full. bulk_load fills leaves
+// to at least half, but at a low fill may give an inner node as few as two
+// children. Apart from those, every node but the root and the last one on
+// each level is at least half full; a leaf holds at least one key and an
+// inner node at least two children.
+//
+// Iterators are constant (keys order the tree) and are invalidated by any
+// insert or erase.
+template<class T, class Compare = std::less<T>>
 class btree
 {
+public:
+	typedef T key_type;
+	typedef T value_type;
+	typedef Compare key_compare;
+	typedef const T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	class const_iterator;
+	typedef const_iterator iterator;
+	class node_view;
+	class preorder_iterator;
+	class levelorder_iterator;
+
+	static constexpr size_type leaf_capacity = btree_leaf_capacity<T>();
+	static constexpr size_type inner_capacity = btree_inner_capacity<T>();
+
+private:
 	struct Node
 	{
-		Node(const T& _data, Node* _left = nullptr, Node* _right = nullptr):
-			data(_data), left(_left), right(_right) {}
-		T data;
-		// TODO; Node structuring
-		Node* left;
-		Node* right;
+		// keys held
+		std::uint16_t n;
+		bool leaf;
 	};
 
-	int count_nodes(Node*);
-	btree(std::initializer_list<Node>);
+	struct alignas(64) Leaf: Node
+	{
+		Leaf():
+			Node{0, true}, prev(nullptr), next(nullptr) {}
 
-public:
+		inline T* at(size_type i)
+			{ return std::launder(reinterpret_cast<T*>(storage)) + i; }
+		inline const T* at(size_type i) const
+			{ return std::launder(reinterpret_cast<const T*>(storage)) + i; }
+
+		Leaf* prev;
+		Leaf* next;
+		alignas(T) unsigned char storage[leaf_capacity * sizeof(T)];
+	};
+
+	struct alignas(64) Inner: Node
+	{
+		Inner():
+			Node{0, false} {}
 
+		inline T* at(size_type i)
+			{ return std::launder(reinterpret_cast<T*>(storage)) + i; }
+		inline const T* at(size_type i) const
+			{ return std::launder(reinterpret_cast<const T*>(storage)) + i; }
+
+		alignas(T) unsigned char storage[inner_capacity * sizeof(T)];
+		Node* child[inner_capacity + 1];
+	};
+
+	// one level of a root-to-leaf walk: the inner node and the child taken
+	struct Step
+	{
+		Inner* node;
+		size_type idx;
+	};
+
+	// deeper than any tree that fits in memory, even at minimum fan-out
+	static constexpr size_type max_height = 64;
+
+	Node* root;
+	Leaf* first;
+	Leaf* last;
+	// number of keys, kept current by every insert/erase
+	size_type count;
+	// levels from root to leaves; 0 when empty
+	size_type levels;
+	// leaves and inner nodes allocated, kept current by make_*/drop
+	size_type nodes;
+	Compare comp;
+
+	Leaf* make_leaf();
+	Inner* make_inner();
+	void drop(Leaf*);
+	void drop(Inner*);
+
+	// first position in a[0, n) whose key is not less than / greater than key
+	size_type lower(const T* a, size_type n, const T& key) const;
+	size_type upper(const T* a, size_type n, const T& key) const;
+
+	// walk from the root to the leaf that would hold key, recording the path
+	Leaf* descend(const T& key, Step* path, size_type& depth) const;
+	Leaf* descend(const T& key) const;
+
+	// raw key array moves; a has room for one more key in shift_in
+	static void shift_in(T* a, size_type n, size_type pos, T&& v);
+	static void shift_out(T* a, size_type n, size_type pos);
+	static void relocate(T* src, size_type k, T* dst);
+
+	// move keys from m up into a new right sibling; an inner split sends key
+	// m up instead and leaves it constructed at at(m) for the caller to move
+	Leaf* split(Leaf*, size_type m);
+	Inner* split(Inner*, size_type m);
+
+	// add separator sep and its right child to the inner node above
+	// path[depth - 1], splitting upward; append means right is the new last
+	// node of its level, so full nodes split off nearly empty right siblings
+	void push_up(Step* path, size_type depth, T&& sep, Node* right, bool append);
+	// put key sep at i and right at child i + 1 in a node with room
+	void inner_insert(Inner*, size_type i, T&& sep, Node* right);
+	// drop key i and child i + 1
+	void inner_erase(Inner*, size_type i);
+
+	// remove key pos of leaf l, reached through path; returns the successor
+	const_iterator erase_at(Step* path, size_type depth, Leaf* l, size_type pos);
+
+	// refill or merge the underfull inner node path[depth].node
+	void rebalance(Step* path, size_type depth);
+
+	template<class V>
+	std::pair<Leaf*, size_type> insert_value(V&&, bool& added);
+
+	// entries per node for a bulk-load fill factor, clamped to [0.5, 1]
+	static size_type fill_count(size_type capacity, double fill);
+	// stack the inner levels over a finished run of leaves
+	void build_levels(std::vector<Node*>& level, std::vector<const T*>& mins,
+		std::vector<Inner*>& built, size_type per_node);
+
+	// the leaf chain as runs of adjacent keys, for compare.h
+	struct runs
+	{
+		explicit runs(const Leaf* _first):
+			leaf(_first), p(nullptr), e(nullptr) {}
+
+		bool next()
+		{
+			if(leaf == nullptr) return false;
+			p = leaf->at(0);
+			e = leaf->at(leaf->n);
+			leaf = leaf->next;
+			return true;
+		}
+
+		const Leaf* leaf;
+		const T* p;
+		const T* e;
+	};
+
+	// copy x's subtree into slot; each node is linked in as soon as it is
+	// made, so a throwing copy leaves a tree clear() can free
+	void clone(const Node* x, Node*& slot, Leaf*& prev);
+	void destroy(Node*);
+	void steal(btree& other) noexcept;
+
+public:
 	btree();
-	btree(const btree<T>&);
+	explicit btree(const Compare&);
+	btree(const btree&);
+	// bulk load from [first, last), which must already be in ascending order
+	template<class InputIt>
+	btree(sorted_unique_t, InputIt first, InputIt last, double fill = 1.0, const Compare& = Compare());
+	btree(btree&&) noexcept;
+
+	btree& operator=(const btree&);
+	btree& operator=(btree&&) noexcept;
+
+	template<class E, class C>
+	friend bool operator==(const btree<E, C>&, const btree<E, C>&);
+	template<class E, class C>
+	friend bool operator!=(const btree<E, C>&, const btree<E, C>&);
+	template<class E, class C>
+	friend std::ostream& operator<<(std::ostream&, const btree<E, C>&);
+	template<class E, class C>
+	friend std::istream& operator>>(std::istream&, btree<E, C>&);
+	// btree_io.h: rebuilds the nodes of a snapshot as they were saved
+	template<class E, class C>
+	friend bool load_binary(const char*, const char*, btree<E, C>&);
+
+	// return true if empty
+	bool empty() const;
+
+	// return number of keys
+	size_type size() const;
+
+	// return levels from root to leaf
+	size_type height() const;
+
+	// return number of nodes, leaves and inner
+	size_type node_count() const;
+
+	key_compare key_comp() const;
+
+	// add key; the iterator points at the key in the tree, and the bool is
+	// false if an equal key was already there
+	std::pair<iterator, bool> insert(const T&);
+	std::pair<iterator, bool> insert(T&&);
+
+	// remove key; returns the number removed
+	size_type erase(const T&);
+	// remove the key at pos; returns the position after it
+	iterator erase(const const_iterator& pos);
+
+	// remove all keys
+	void clear();
+
+	void swap(btree&) noexcept;
+
+	// replace the contents with the keys of an ascending range, built bottom
+	// up in one pass; nodes are filled to fill of their capacity (0.5 to 1)
+	// so later inserts have room. Keys not greater than the one before are
+	// skipped. Works on any input range, a sorted slist included.
+	template<class InputIt>
+	void bulk_load(InputIt first, InputIt last, double fill = 1.0);
+
+	// position of key, or end()
+	const_iterator find(const T&) const;
+	// number of keys equal to key, 0 or 1
+	size_type count_of(const T&) const;
+	// first key not less than / greater than key
+	const_iterator lower_bound(const T&) const;
+	const_iterator upper_bound(const T&) const;
+
+	// return true if both trees hold the same keys
+	bool equals(const btree&) const;
+
+	// lexicographic order of the keys in order, by operator< like the
+	// standard containers: <0, 0 or >0 as this tree sorts before, with or after other
+	int compare(const btree&) const;
+
+	// hash of the keys in order; trees that compare equal hash alike
+	std::size_t hash() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	// structural walks over the nodes themselves; begin() to end() is the
+	// in-order walk over keys. Both run on explicit state, not recursion.
+	// every node, parent before children, left to right
+	preorder_iterator preorder_begin() const;
+	preorder_iterator preorder_end() const;
+	// every node, level by level from the root, left to right
+	levelorder_iterator levelorder_begin() const;
+	levelorder_iterator levelorder_end() const;
+
+	// one node per line in pre-order, indented by depth
+	std::ostream& dump(std::ostream&) const;
+
+	// keys in order, space separated
+	std::string to_string() const;
 
-	template<class E>
-	friend std::ostream& operator<<(std::ostream&, typename btree<E>::Node*);
-	template<class E>
-	friend std::istream& operator>>(std::istream&, const btree<E>&);
+	// destroy
+	~btree();
+};
+
+// A (leaf, index) position. end() is a null leaf, so it stays valid as the
+// last leaf grows; stepping back from it goes through the tree.
+template<class T, class Compare>
+class btree<T, Compare>::const_iterator
+{
+	friend class btree;
+
+	const_iterator(const btree* _tree, Leaf* _leaf, size_type _idx):
+		tree(_tree), leaf(_leaf), idx(_idx) {}
+
+	const btree* tree;
+	Leaf* leaf;
+	size_type idx;
+
+public:
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	const_iterator():
+		tree(nullptr), leaf(nullptr), idx(0) {}
 
-	iterator insert(const T& data);
-	const_iterator insert(const T& data) const;
+	inline const_iterator& operator++()
+	{
+		if(++idx == leaf->n)
+		{
+			leaf = leaf->next;
+			idx = 0;
+		}
+		return *this;
+	}
 
-	std::string to_string();
+	inline const_iterator operator++(int)
+	{
+		const_iterator old(*this);
+		++(*this);
+		return old;
+	}
+
+	inline const_iterator& operator--()
+	{
+		if(leaf == nullptr)
+		{
+			leaf = tree->last;
+			idx = leaf->n - 1;
+		}
+		else if(idx == 0)
+		{
+			leaf = leaf->prev;
+			idx = leaf->n - 1;
+		}
+		else
+		{
+			--idx;
+		}
+		return *this;
+	}
+
+	inline const_iterator operator--(int)
+	{
+		const_iterator old(*this);
+		--(*this);
+		return old;
+	}
+
+	inline bool operator==(const const_iterator& rhs) const
+		{ return leaf == rhs.leaf && idx == rhs.idx; }
+	inline bool operator!=(const const_iterator& rhs) const
+		{ return !(*this == rhs); }
+
+	inline const T& operator*() const
+		{ return *leaf->at(idx); }
+	inline const T* operator->() const
+		{ return leaf->at(idx); }
+};
+
+// Read-only look at one node: its keys and how deep it sits. An inner
+// node with size() keys has size() + 1 children.
+template<class T, class Compare>
+class btree<T, Compare>::node_view
+{
+	friend class btree;
+
+	node_view(const Node* _node, size_type _depth):
+		node(_node), lvl(_depth) {}
+
+	const Node* node;
+	size_type lvl;
+
+public:
+	inline bool is_leaf() const
+		{ return node->leaf; }
+	inline size_type size() const
+		{ return node->n; }
+	// levels below the root
+	inline size_type depth() const
+		{ return lvl; }
+	inline const T& key(size_type i) const
+	{
+		return node->leaf ? *static_cast<const Leaf*>(node)->at(i)
+			: *static_cast<const Inner*>(node)->at(i);
+	}
+};
+
+// Pre-order walk. The stack holds each inner node above the current one and
+// the child being visited, so it never grows past height() entries.
+template<class T, class Compare>
+class btree<T, Compare>::preorder_iterator
+{
+	friend class btree;
+
+	explicit preorder_iterator(const Node* root):
+		node(root) {}
+
+	std::vector<Step> path;
+	const Node* node;
+
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef node_view value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const node_view* pointer;
+	typedef node_view reference;
+
+	preorder_iterator():
+		node(nullptr) {}
+
+	inline preorder_iterator& operator++()
+	{
+		if(!node->leaf)
+		{
+			Inner* in = static_cast<Inner*>(const_cast<Node*>(node));
+			path.push_back(Step{in, 0});
+			node = in->child[0];
+			return *this;
+		}
+
+		while(!path.empty() && path.back().idx == path.back().node->n)
+			path.pop_back();
+		if(path.empty())
+		{
+			node = nullptr;
+			return *this;
+		}
+		node = path.back().node->child[++path.back().idx];
+		return *this;
+	}
+
+	inline preorder_iterator operator++(int)
+	{
+		preorder_iterator old(*this);
+		++(*this);
+		return old;
+	}
+
+	inline bool operator==(const preorder_iterator& rhs) const
+		{ return node == rhs.node; }
+	inline bool operator!=(const preorder_iterator& rhs) const
+		{ return !(*this == rhs); }
+
+	inline node_view operator*() const
+		{ return node_view(node, path.size()); }
+};
+
+// Level-order walk. Inner levels are held one row at a time; the leaf
+// level, by far the widest, is walked along the leaf links instead.
+template<class T, class Compare>
+class btree<T, Compare>::levelorder_iterator
+{
+	friend class btree;
+
+	explicit levelorder_iterator(const Node* root):
+		pos(0), lvl(0), leaf(nullptr)
+	{
+		if(root == nullptr) return;
+		if(root->leaf) leaf = static_cast<const Leaf*>(root);
+		else row.push_back(root);
+	}
+
+	std::vector<const Node*> row;
+	size_type pos;
+	size_type lvl;
+	const Leaf* leaf;
+
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef node_view value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const node_view* pointer;
+	typedef node_view reference;
+
+	levelorder_iterator():
+		pos(0), lvl(0), leaf(nullptr) {}
+
+	inline levelorder_iterator& operator++()
+	{
+		if(leaf != nullptr)
+		{
+			leaf = leaf->next;
+			return *this;
+		}
+		if(++pos < row.size()) return *this;
+
+		const Inner* head = static_cast<const Inner*>(row.front());
+		++lvl;
+		pos = 0;
+		if(head->child[0]->leaf)
+		{
+			leaf = static_cast<const Leaf*>(head->child[0]);
+			row.clear();
+			return *this;
+		}
+
+		std::vector<const Node*> next;
+		for(const Node* x: row)
+		{
+			const Inner* in = static_cast<const Inner*>(x);
+			for(size_type k = 0; k <= in->n; ++k)
+				next.push_back(in->child[k]);
+		}
+		row.swap(next);
+		return *this;
+	}
+
+	inline levelorder_iterator operator++(int)
+	{
+		levelorder_iterator old(*this);
+		++(*this);
+		return old;
+	}
+
+	inline bool operator==(const levelorder_iterator& rhs) const
+		{ return current() == rhs.current(); }
+	inline bool operator!=(const levelorder_iterator& rhs) const
+		{ return !(*this == rhs); }
+
+	inline node_view operator*() const
+		{ return node_view(current(), lvl); }
 
 private:
-	Node* root;
+	inline const Node* current() const
+		{ return leaf != nullptr ? leaf : (row.empty() ? nullptr : row[pos]); }
 };
 
-template<class T>
-btree<T>::btree():
-	root(new btree<T>::Node(T())) {}
+template<class T, class Compare>
+inline bool operator==(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return lhs.equals(rhs); }
 
-template<class T>
-btree<T>::btree(const btree<T>& other):
-	root(new btree<T>::Node(T()))
+template<class T, class Compare>
+inline bool operator!=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return !lhs.equals(rhs); }
+
+template<class T, class Compare>
+inline bool operator<(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return lhs.compare(rhs) < 0; }
+
+template<class T, class Compare>
+inline bool operator<=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return lhs.compare(rhs) <= 0; }
+
+template<class T, class Compare>
+inline bool operator>(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return lhs.compare(rhs) > 0; }
+
+template<class T, class Compare>
+inline bool operator>=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+	{ return lhs.compare(rhs) >= 0; }
+
+namespace std
+{
+	template<class T, class Compare>
+	struct hash<btree<T, Compare>>
+	{
+		std::size_t operator()(const btree<T, Compare>& rhs) const
+			{ return rhs.hash(); }
+	};
+}
+
+template<class T, class Compare>
+std::ostream& operator<<(std::ostream& os, const btree<T, Compare>& rhs)
 {
-	std::ostream& feed;
-	feed << other.root;
-	for(std::getline())
+	for(typename btree<T, Compare>::const_iterator it = rhs.begin(); it != rhs.end(); ++it)
+		os << (*it) << ' ';
+	return os;
 }
 
-template<class T>
-std::ostream& operator<<(std::ostream& os, typename btree<T>::Node* root)
+// reads whitespace separated keys until extraction fails, adding each
+template<class T, class Compare>
+std::istream& operator>>(std::istream& is, btree<T, Compare>& rhs)
 {
-	if(root != nullptr)
+	T data;
+	while(is >> data)
+		rhs.insert(std::move(data));
+	if(is.eof())
+		is.clear(std::ios::eofbit);
+	return is;
+}
+
+// Constructor
+template<class T, class Compare>
+btree<T, Compare>::btree():
+	root(nullptr), first(nullptr), last(nullptr), count(0), levels(0), nodes(0), comp() {}
+
+template<class T, class Compare>
+btree<T, Compare>::btree(const Compare& c):
+	root(nullptr), first(nullptr), last(nullptr), count(0), levels(0), nodes(0), comp(c) {}
+
+// sorted range constructor
+template<class T, class Compare>
+template<class InputIt>
+btree<T, Compare>::btree(sorted_unique_t, InputIt first, InputIt last, double fill, const Compare& c):
+	root(nullptr), first(nullptr), last(nullptr), count(0), levels(0), nodes(0), comp(c)
+	{ bulk_load(first, last, fill); }
+
+// Copy constructor; clones the node structure level by level, no re-sorting
+template<class T, class Compare>
+btree<T, Compare>::btree(const btree& other):
+	root(nullptr), first(nullptr), last(nullptr), count(0), levels(0), nodes(0), comp(other.comp)
+{
+	if(other.root != nullptr)
 	{
-		os << root->data << ' ';
-		os << (root->left);
-		os << (root->right);
+		Leaf* prev = nullptr;
+		try
+		{
+			clone(other.root, root, prev);
+		}
+		catch(...)
+		{
+			clear();
+			throw;
+		}
+		last = prev;
+		count = other.count;
+		levels = other.levels;
 	}
+}
 
-	return os;
+template<class T, class Compare>
+btree<T, Compare>::btree(btree&& other) noexcept:
+	root(nullptr), first(nullptr), last(nullptr), count(0), levels(0), nodes(0), comp(other.comp)
+	{ steal(other); }
+
+template<class T, class Compare>
+btree<T, Compare>& btree<T, Compare>::operator=(const btree& other)
+{
+	if(this != &other)
+	{
+		btree copy(other);
+		swap(copy);
+	}
+	return *this;
 }
 
-template<class T>
-std::istream& operator>>(std::istream& is, btree<T>& rhs)
+template<class T, class Compare>
+btree<T, Compare>& btree<T, Compare>::operator=(btree&& other) noexcept
 {
-	std::stringstream ss(is);
-	
+	if(this != &other)
+	{
+		clear();
+		comp = other.comp;
+		steal(other);
+	}
+	return *this;
 }
 
-template<class T>
-int btree<T>::count_nodes(Node* root)
+// Destructor
+template<class T, class Compare>
+btree<T, Compare>::~btree()
+	{ clear(); }
+
+// empty()					//Returns true if this tree contains no keys.
+template<class T, class Compare>
+inline bool btree<T, Compare>::empty() const
+	{ return count == 0; }
+
+// size()					//Returns the number of keys in this tree.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::size() const
+	{ return count; }
+
+// height()					//Returns the number of levels from root to leaf.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::height() const
+	{ return levels; }
+
+// node_count()				//Returns the number of nodes in this tree.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::node_count() const
+	{ return nodes; }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::key_compare btree<T, Compare>::key_comp() const
+	{ return comp; }
+
+// lower(keys, n, key)		//Binary search for the first key not less than key.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::lower(const T* a, size_type n, const T& key) const
+{
+	size_type lo = 0;
+	while(n > 0)
+	{
+		size_type half = n / 2;
+		if(comp(a[lo + half], key))
+		{
+			lo += half + 1;
+			n -= half + 1;
+		}
+		else
+		{
+			n = half;
+		}
+	}
+	return lo;
+}
+
+// upper(keys, n, key)		//Binary search for the first key greater than key.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::upper(const T* a, size_type n, const T& key) const
+{
+	size_type lo = 0;
+	while(n > 0)
+	{
+		size_type half = n / 2;
+		if(!comp(key, a[lo + half]))
+		{
+			lo += half + 1;
+			n -= half + 1;
+		}
+		else
+		{
+			n = half;
+		}
+	}
+	return lo;
+}
+
+// descend(key, path, depth)	//Returns the leaf for key; path gets each inner node and the child taken.
+template<class T, class Compare>
+inline typename btree<T, Compare>::Leaf* btree<T, Compare>::descend(const T& key, Step* path, size_type& depth) const
+{
+	Node* x = root;
+	depth = 0;
+	while(!x->leaf)
+	{
+		Inner* in = static_cast<Inner*>(x);
+		size_type i = upper(in->at(0), in->n, key);
+		path[depth++] = Step{in, i};
+		x = in->child[i];
+	}
+	return static_cast<Leaf*>(x);
+}
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::Leaf* btree<T, Compare>::descend(const T& key) const
+{
+	Node* x = root;
+	while(!x->leaf)
+	{
+		Inner* in = static_cast<Inner*>(x);
+		x = in->child[upper(in->at(0), in->n, key)];
+	}
+	return static_cast<Leaf*>(x);
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::shift_in(T* a, size_type n, size_type pos, T&& v)
+{
+	if(pos == n)
+	{
+		::new(static_cast<void*>(a + n)) T(std::move(v));
+		return;
+	}
+	::new(static_cast<void*>(a + n)) T(std::move(a[n - 1]));
+	for(size_type k = n - 1; k > pos; --k)
+		a[k] = std::move(a[k - 1]);
+	a[pos] = std::move(v);
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::shift_out(T* a, size_type n, size_type pos)
+{
+	for(size_type k = pos; k + 1 < n; ++k)
+		a[k] = std::move(a[k + 1]);
+	a[n - 1].~T();
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::relocate(T* src, size_type k, T* dst)
+{
+	for(size_type i = 0; i < k; ++i)
+	{
+		::new(static_cast<void*>(dst + i)) T(std::move(src[i]));
+		src[i].~T();
+	}
+}
+
+// split(leaf, m)			//Moves the keys from m up into a new leaf linked in after leaf.
+template<class T, class Compare>
+typename btree<T, Compare>::Leaf* btree<T, Compare>::split(Leaf* l, size_type m)
 {
+	Leaf* r = make_leaf();
+	relocate(l->at(m), l->n - m, r->at(0));
+	r->n = l->n - m;
+	l->n = m;
+
+	r->prev = l;
+	r->next = l->next;
+	if(l->next != nullptr) l->next->prev = r;
+	else last = r;
+	l->next = r;
+	return r;
+}
+
+// split(inner, m)			//Moves the keys above m into a new node; key m stays parked at at(m).
+template<class T, class Compare>
+typename btree<T, Compare>::Inner* btree<T, Compare>::split(Inner* p, size_type m)
+{
+	Inner* q = make_inner();
+	size_type moved = p->n - m - 1;
+
+	relocate(p->at(m + 1), moved, q->at(0));
+	for(size_type k = 0; k <= moved; ++k)
+		q->child[k] = p->child[m + 1 + k];
+	q->n = moved;
+	p->n = m;
+	return q;
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::inner_insert(Inner* p, size_type i, T&& sep, Node* right)
+{
+	shift_in(p->at(0), p->n, i, std::move(sep));
+	for(size_type k = p->n + 1; k > i + 1; --k)
+		p->child[k] = p->child[k - 1];
+	p->child[i + 1] = right;
+	++p->n;
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::inner_erase(Inner* p, size_type i)
+{
+	shift_out(p->at(0), p->n, i);
+	for(size_type k = i + 1; k < p->n; ++k)
+		p->child[k] = p->child[k + 1];
+	--p->n;
+}
+
+// push_up(path, depth, sep, right)	//Hangs a new right sibling under its parent, splitting full parents on the way up.
+template<class T, class Compare>
+void btree<T, Compare>::push_up(Step* path, size_type depth, T&& sep, Node* right, bool append)
+{
+	T carry(std::move(sep));
+
+	while(depth > 0)
+	{
+		Step s = path[--depth];
+		Inner* p = s.node;
+		if(p->n < inner_capacity)
+		{
+			inner_insert(p, s.idx, std::move(carry), right);
+			return;
+		}
+
+		// p is full: split it, place the new separator in the half that
+		// owns child s.idx, and carry the key between the halves up a level.
+		// Ascending inserts only ever split the last node, so there the left
+		// half is kept full instead of half empty.
+		Inner* q = split(p, append ? p->n - 1 : p->n / 2);
+		size_type m = p->n;
+		T up(std::move(*p->at(m)));
+		p->at(m)->~T();
+		if(s.idx <= m) inner_insert(p, s.idx, std::move(carry), right);
+		else inner_insert(q, s.idx - m - 1, std::move(carry), right);
+
+		carry = std::move(up);
+		right = q;
+	}
+
+	// the root split: grow a level
+	Inner* r = make_inner();
+	::new(static_cast<void*>(r->at(0))) T(std::move(carry));
+	r->child[0] = root;
+	r->child[1] = right;
+	r->n = 1;
+	root = r;
+	++levels;
+}
+
+template<class T, class Compare>
+template<class V>
+std::pair<typename btree<T, Compare>::Leaf*, typename btree<T, Compare>::size_type>
+	btree<T, Compare>::insert_value(V&& data, bool& added)
+{
+	added = true;
 	if(root == nullptr)
 	{
-		return 0;
+		Leaf* l = make_leaf();
+		::new(static_cast<void*>(l->at(0))) T(std::forward<V>(data));
+		l->n = 1;
+		root = first = last = l;
+		count = 1;
+		levels = 1;
+		return std::make_pair(l, size_type(0));
+	}
+
+	Step path[max_height];
+	size_type depth;
+	Leaf* l = descend(data, path, depth);
+	size_type pos = lower(l->at(0), l->n, data);
+	if(pos < l->n && !comp(data, *l->at(pos)))
+	{
+		added = false;
+		return std::make_pair(l, pos);
+	}
+
+	T value(std::forward<V>(data));
+	if(l->n == leaf_capacity && pos == l->n && l->next == nullptr)
+	{
+		// appending past the largest key: leave this leaf full and start a new one
+		Leaf* r = split(l, l->n);
+		::new(static_cast<void*>(r->at(0))) T(std::move(value));
+		r->n = 1;
+		++count;
+		push_up(path, depth, T(*r->at(0)), r, true);
+		return std::make_pair(r, size_type(0));
+	}
+	if(l->n == leaf_capacity)
+	{
+		// hang the new leaf first; its first key is the separator
+		Leaf* r = split(l, l->n / 2);
+		push_up(path, depth, T(*r->at(0)), r, false);
+		if(pos > l->n)
+		{
+			pos -= l->n;
+			l = r;
+		}
+	}
+
+	shift_in(l->at(0), l->n, pos, std::move(value));
+	++l->n;
+	++count;
+	return std::make_pair(l, pos);
+}
+
+// insert(key)				//Adds key to this tree unless an equal key is present.
+template<class T, class Compare>
+inline std::pair<typename btree<T, Compare>::iterator, bool> btree<T, Compare>::insert(const T& data)
+{
+	bool added;
+	std::pair<Leaf*, size_type> at = insert_value(data, added);
+	return std::make_pair(const_iterator(this, at.first, at.second), added);
+}
+
+template<class T, class Compare>
+inline std::pair<typename btree<T, Compare>::iterator, bool> btree<T, Compare>::insert(T&& data)
+{
+	bool added;
+	std::pair<Leaf*, size_type> at = insert_value(std::move(data), added);
+	return std::make_pair(const_iterator(this, at.first, at.second), added);
+}
+
+// erase(key)				//Removes key from this tree; returns the number of keys removed.
+template<class T, class Compare>
+typename btree<T, Compare>::size_type btree<T, Compare>::erase(const T& key)
+{
+	if(root == nullptr) return 0;
+
+	Step path[max_height];
+	size_type depth;
+	Leaf* l = descend(key, path, depth);
+	size_type pos = lower(l->at(0), l->n, key);
+	if(pos == l->n || comp(key, *l->at(pos))) return 0;
+
+	erase_at(path, depth, l, pos);
+	return 1;
+}
+
+// erase(pos)				//Removes the key at pos; returns the position of the key after it.
+template<class T, class Compare>
+typename btree<T, Compare>::iterator btree<T, Compare>::erase(const const_iterator& it)
+{
+	Step path[max_height];
+	size_type depth;
+	descend(*it, path, depth);
+	return erase_at(path, depth, it.leaf, it.idx);
+}
+
+// erase_at(path, depth, leaf, pos)	//Removes a key from its leaf, then borrows or merges up the path as needed.
+template<class T, class Compare>
+typename btree<T, Compare>::const_iterator btree<T, Compare>::erase_at(Step* path, size_type depth, Leaf* l, size_type pos)
+{
+	shift_out(l->at(0), l->n, pos);
+	--l->n;
+	--count;
+
+	// where the successor sits; rebalancing below keeps this current
+	Leaf* next = l;
+	size_type next_idx = pos;
+	if(next_idx == l->n)
+	{
+		next = l->next;
+		next_idx = 0;
+	}
+
+	if(depth == 0)
+	{
+		if(l->n == 0)
+		{
+			drop(l);
+			root = first = last = nullptr;
+			levels = 0;
+		}
+		return const_iterator(this, next, next_idx);
+	}
+
+	if(l->n >= leaf_capacity / 2)
+		return const_iterator(this, next, next_idx);
+
+	Inner* p = path[depth - 1].node;
+	size_type i = path[depth - 1].idx;
+
+	if(i < p->n)
+	{
+		Leaf* r = static_cast<Leaf*>(p->child[i + 1]);
+		if(r->n > leaf_capacity / 2)
+		{
+			// borrow the right sibling's first key
+			::new(static_cast<void*>(l->at(l->n))) T(std::move(*r->at(0)));
+			++l->n;
+			shift_out(r->at(0), r->n, 0);
+			--r->n;
+			*p->at(i) = *r->at(0);
+			if(next == r)
+			{
+				next = l;
+				next_idx = l->n - 1;
+			}
+			return const_iterator(this, next, next_idx);
+		}
+
+		// absorb the right sibling
+		size_type base = l->n;
+		relocate(r->at(0), r->n, l->at(base));
+		l->n += r->n;
+		l->next = r->next;
+		if(r->next != nullptr) r->next->prev = l;
+		else last = l;
+		if(next == r)
+		{
+			next = l;
+			next_idx = base;
+		}
+		drop(r);
+		inner_erase(p, i);
 	}
 	else
 	{
-		int count = 1;
-		count += count_nodes(root->left);
-		count += count_nodes(root->right);
+		Leaf* s = static_cast<Leaf*>(p->child[i - 1]);
+		if(s->n > leaf_capacity / 2)
+		{
+			// borrow the left sibling's last key
+			shift_in(l->at(0), l->n, 0, std::move(*s->at(s->n - 1)));
+			++l->n;
+			s->at(s->n - 1)->~T();
+			--s->n;
+			*p->at(i - 1) = *l->at(0);
+			if(next == l) ++next_idx;
+			return const_iterator(this, next, next_idx);
+		}
 
-		return count;
+		// fold into the left sibling
+		size_type base = s->n;
+		relocate(l->at(0), l->n, s->at(base));
+		s->n += l->n;
+		s->next = l->next;
+		if(l->next != nullptr) l->next->prev = s;
+		else last = s;
+		if(next == l)
+		{
+			next = s;
+			next_idx += base;
+		}
+		drop(l);
+		inner_erase(p, i - 1);
 	}
+
+	rebalance(path, depth - 1);
+	return const_iterator(this, next, next_idx);
 }
 
-/*
-template<class T>
-std::ostream& btree<T>::get_data(std::ostream& os, Node* root)
+// rebalance(path, depth)	//Restores the half-full minimum of path[depth].node after it lost a child.
+template<class T, class Compare>
+void btree<T, Compare>::rebalance(Step* path, size_type depth)
 {
-	if(root != NULL)
+	for(;;)
 	{
-		os << root->item;
-		to_string(os, root->left);
-		to_string(os, root->right);
+		Inner* x = path[depth].node;
+
+		if(depth == 0)
+		{
+			// the root keeps no minimum, but a root with one child is a wasted level
+			if(x->n == 0)
+			{
+				root = x->child[0];
+				drop(x);
+				--levels;
+			}
+			return;
+		}
+
+		if(x->n >= inner_capacity / 2) return;
+
+		Inner* p = path[depth - 1].node;
+		size_type i = path[depth - 1].idx;
+
+		if(i < p->n)
+		{
+			Inner* r = static_cast<Inner*>(p->child[i + 1]);
+			if(r->n > inner_capacity / 2)
+			{
+				// rotate through the parent: separator down into x, r's first key up
+				::new(static_cast<void*>(x->at(x->n))) T(std::move(*p->at(i)));
+				x->child[x->n + 1] = r->child[0];
+				++x->n;
+				*p->at(i) = std::move(*r->at(0));
+				shift_out(r->at(0), r->n, 0);
+				for(size_type k = 0; k < r->n; ++k)
+					r->child[k] = r->child[k + 1];
+				--r->n;
+				return;
+			}
+
+			// merge x, the separator and r
+			::new(static_cast<void*>(x->at(x->n))) T(std::move(*p->at(i)));
+			relocate(r->at(0), r->n, x->at(x->n + 1));
+			for(size_type k = 0; k <= r->n; ++k)
+				x->child[x->n + 1 + k] = r->child[k];
+			x->n += 1 + r->n;
+			drop(r);
+			inner_erase(p, i);
+		}
+		else
+		{
+			Inner* s = static_cast<Inner*>(p->child[i - 1]);
+			if(s->n > inner_capacity / 2)
+			{
+				// rotate through the parent: separator down into x, s's last key up
+				shift_in(x->at(0), x->n, 0, std::move(*p->at(i - 1)));
+				for(size_type k = x->n + 1; k > 0; --k)
+					x->child[k] = x->child[k - 1];
+				x->child[0] = s->child[s->n];
+				++x->n;
+				*p->at(i - 1) = std::move(*s->at(s->n - 1));
+				s->at(s->n - 1)->~T();
+				--s->n;
+				return;
+			}
+
+			// merge s, the separator and x
+			::new(static_cast<void*>(s->at(s->n))) T(std::move(*p->at(i - 1)));
+			relocate(x->at(0), x->n, s->at(s->n + 1));
+			for(size_type k = 0; k <= x->n; ++k)
+				s->child[s->n + 1 + k] = x->child[k];
+			s->n += 1 + x->n;
+			drop(x);
+			inner_erase(p, i - 1);
+		}
+
+		--depth;
 	}
+}
 
-	return os;
-}*/
+template<class T, class Compare>
+inline typename btree<T, Compare>::Leaf* btree<T, Compare>::make_leaf()
+{
+	Leaf* l = new Leaf();
+	++nodes;
+	return l;
+}
 
-template<class T>
-std::string btree<T>::to_string()
+template<class T, class Compare>
+inline typename btree<T, Compare>::Inner* btree<T, Compare>::make_inner()
 {
-	std::stringstream ss;
+	Inner* in = new Inner();
+	++nodes;
+	return in;
 }
 
-#endif
+template<class T, class Compare>
+inline void btree<T, Compare>::drop(Leaf* l)
+{
+	delete l;
+	--nodes;
+}
+
+template<class T, class Compare>
+inline void btree<T, Compare>::drop(Inner* in)
+{
+	delete in;
+	--nodes;
+}
+
+// fill_count(capacity, fill)	//Returns how many of capacity slots a bulk load fills.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::fill_count(size_type capacity, double fill)
+{
+	if(!(fill >= 0.5)) fill = 0.5;
+	if(fill > 1.0) fill = 1.0;
+	size_type n = size_type(capacity * fill);
+	return n < 2 ? 2 : n;
+}
+
+// bulk_load(first, last, fill)	//Rebuilds this tree from an ascending range in O(n).
+template<class T, class Compare>
+template<class InputIt>
+void btree<T, Compare>::bulk_load(InputIt from, InputIt to, double fill)
+{
+	clear();
+
+	const size_type per_leaf = fill_count(leaf_capacity, fill);
+	std::vector<Node*> level;
+	std::vector<const T*> mins;
+	std::vector<Inner*> built;
+
+	try
+	{
+		// leaves, left to right, each filled to per_leaf
+		Leaf* l = nullptr;
+		for(; from != to; ++from)
+		{
+			if(l != nullptr && !comp(*last->at(last->n - 1), *from)) continue;
+
+			if(l == nullptr || l->n == per_leaf)
+			{
+				Leaf* r = make_leaf();
+				r->prev = l;
+				if(l != nullptr) l->next = r;
+				else first = r;
+				last = l = r;
+				level.push_back(l);
+			}
+			::new(static_cast<void*>(l->at(l->n))) T(*from);
+			++l->n;
+			++count;
+		}
+
+		if(level.empty()) return;
+
+		// the run may end on a nearly empty leaf: fold it into its neighbour
+		// if both fit in one, otherwise even the two out
+		if(level.size() > 1 && l->n < leaf_capacity / 2)
+		{
+			Leaf* p = l->prev;
+			if(p->n + l->n <= leaf_capacity)
+			{
+				relocate(l->at(0), l->n, p->at(p->n));
+				p->n += l->n;
+				p->next = nullptr;
+				last = p;
+				drop(l);
+				level.pop_back();
+			}
+			else
+			{
+				size_type move = (p->n - l->n) / 2;
+				for(size_type k = l->n; k > 0; --k)
+				{
+					::new(static_cast<void*>(l->at(k - 1 + move))) T(std::move(*l->at(k - 1)));
+					l->at(k - 1)->~T();
+				}
+				relocate(p->at(p->n - move), move, l->at(0));
+				p->n -= move;
+				l->n += move;
+			}
+		}
+
+		mins.reserve(level.size());
+		for(Node* x: level)
+			mins.push_back(static_cast<Leaf*>(x)->at(0));
+
+		levels = 1;
+		build_levels(level, mins, built, fill_count(inner_capacity + 1, fill));
+		root = level.front();
+	}
+	catch(...)
+	{
+		// inner nodes were built without owning their children yet; free
+		// their keys and the leaves one by one
+		for(Inner* in: built)
+		{
+			for(size_type k = 0; k < in->n; ++k) in->at(k)->~T();
+			drop(in);
+		}
+		for(Leaf* l = first; l != nullptr; )
+		{
+			Leaf* next = l->next;
+			for(size_type k = 0; k < l->n; ++k) l->at(k)->~T();
+			drop(l);
+			l = next;
+		}
+		root = nullptr;
+		first = last = nullptr;
+		count = 0;
+		levels = 0;
+		throw;
+	}
+}
+
+// build_levels(level, mins, built, per_node)	//Groups each level's nodes under new parents until one root is left.
+template<class T, class Compare>
+void btree<T, Compare>::build_levels(std::vector<Node*>& level, std::vector<const T*>& mins,
+	std::vector<Inner*>& built, size_type per_node)
+{
+	// an inner node needs two children; with at least three per node, an
+	// even spread of two or more children never leaves a group of one
+	if(per_node < 3) per_node = 3;
+
+	while(level.size() > 1)
+	{
+		// spread the children evenly over as few parents as the fill allows
+		size_type m = level.size();
+		size_type groups = (m + per_node - 1) / per_node;
+		size_type base = m / groups;
+		size_type extra = m % groups;
+
+		std::vector<Node*> up;
+		std::vector<const T*> up_mins;
+		up.reserve(groups);
+		up_mins.reserve(groups);
+
+		size_type c = 0;
+		for(size_type g = 0; g < groups; ++g)
+		{
+			size_type take = base + (g < extra ? 1 : 0);
+			Inner* in = make_inner();
+			built.push_back(in);
+
+			in->child[0] = level[c];
+			up_mins.push_back(mins[c]);
+			for(size_type k = 1; k < take; ++k)
+			{
+				::new(static_cast<void*>(in->at(in->n))) T(*mins[c + k]);
+				++in->n;
+				in->child[k] = level[c + k];
+			}
+			c += take;
+			up.push_back(in);
+		}
+
+		level.swap(up);
+		mins.swap(up_mins);
+		++levels;
+	}
+}
+
+// clear()					//Removes all keys from this tree.
+template<class T, class Compare>
+void btree<T, Compare>::clear()
+{
+	if(root != nullptr) destroy(root);
+	root = nullptr;
+	first = last = nullptr;
+	count = 0;
+	levels = 0;
+}
+
+// destroy(node)			//Frees node and everything below it; recursion is bounded by the height.
+// Null children are skipped: a snapshot load that fails part way leaves some.
+template<class T, class Compare>
+void btree<T, Compare>::destroy(Node* x)
+{
+	if(x->leaf)
+	{
+		Leaf* l = static_cast<Leaf*>(x);
+		for(size_type k = 0; k < l->n; ++k) l->at(k)->~T();
+		drop(l);
+		return;
+	}
+
+	Inner* in = static_cast<Inner*>(x);
+	for(size_type k = 0; k <= in->n; ++k)
+		if(in->child[k] != nullptr) destroy(in->child[k]);
+	for(size_type k = 0; k < in->n; ++k) in->at(k)->~T();
+	drop(in);
+}
+
+// clone(node, slot, prev)	//Copies node and its subtree into slot; leaves are chained after prev.
+template<class T, class Compare>
+void btree<T, Compare>::clone(const Node* x, Node*& slot, Leaf*& prev)
+{
+	if(x->leaf)
+	{
+		const Leaf* src = static_cast<const Leaf*>(x);
+		Leaf* l = make_leaf();
+		slot = l;
+		l->prev = prev;
+		if(prev != nullptr) prev->next = l;
+		else first = l;
+		prev = l;
+		// n counts the keys built so far, which is all destroy() frees
+		for(; l->n < src->n; ++l->n)
+			::new(static_cast<void*>(l->at(l->n))) T(*src->at(l->n));
+		return;
+	}
+
+	const Inner* src = static_cast<const Inner*>(x);
+	Inner* in = make_inner();
+	for(size_type k = 0; k <= inner_capacity; ++k) in->child[k] = nullptr;
+	slot = in;
+	for(; in->n < src->n; ++in->n)
+		::new(static_cast<void*>(in->at(in->n))) T(*src->at(in->n));
+	for(size_type k = 0; k <= src->n; ++k)
+		clone(src->child[k], in->child[k], prev);
+}
+
+template<class T, class Compare>
+void btree<T, Compare>::steal(btree& other) noexcept
+{
+	root = other.root;
+	first = other.first;
+	last = other.last;
+	count = other.count;
+	levels = other.levels;
+	nodes = other.nodes;
+	other.root = nullptr;
+	other.first = other.last = nullptr;
+	other.count = 0;
+	other.levels = 0;
+	other.nodes = 0;
+}
+
+// swap(other)				//Exchanges the contents of two trees.
+template<class T, class Compare>
+void btree<T, Compare>::swap(btree& other) noexcept
+{
+	std::swap(root, other.root);
+	std::swap(first, other.first);
+	std::swap(last, other.last);
+	std::swap(count, other.count);
+	std::swap(levels, other.levels);
+	std::swap(nodes, other.nodes);
+	std::swap(comp, other.comp);
+}
+
+// find(key)				//Returns the position of key, or end() if it is not in this tree.
+template<class T, class Compare>
+typename btree<T, Compare>::const_iterator btree<T, Compare>::find(const T& key) const
+{
+	if(root == nullptr) return end();
+	Leaf* l = descend(key);
+	size_type pos = lower(l->at(0), l->n, key);
+	if(pos < l->n && !comp(key, *l->at(pos)))
+		return const_iterator(this, l, pos);
+	return end();
+}
+
+// count_of(key)			//Returns 1 if key is in this tree, else 0.
+template<class T, class Compare>
+inline typename btree<T, Compare>::size_type btree<T, Compare>::count_of(const T& key) const
+	{ return find(key) != end() ? 1 : 0; }
+
+// lower_bound(key)			//Returns the first position whose key is not less than key.
+template<class T, class Compare>
+typename btree<T, Compare>::const_iterator btree<T, Compare>::lower_bound(const T& key) const
+{
+	if(root == nullptr) return end();
+	Leaf* l = descend(key);
+	size_type pos = lower(l->at(0), l->n, key);
+	if(pos == l->n)
+		return const_iterator(this, l->next, 0);
+	return const_iterator(this, l, pos);
+}
+
+// upper_bound(key)			//Returns the first position whose key is greater than key.
+template<class T, class Compare>
+typename btree<T, Compare>::const_iterator btree<T, Compare>::upper_bound(const T& key) const
+{
+	if(root == nullptr) return end();
+	Leaf* l = descend(key);
+	size_type pos = upper(l->at(0), l->n, key);
+	if(pos == l->n)
+		return const_iterator(this, l->next, 0);
+	return const_iterator(this, l, pos);
+}
+
+// equals(other)			//Returns true if both trees hold equal keys in the same order.
+template<class T, class Compare>
+bool btree<T, Compare>::equals(const btree& other) const
+{
+	// leaves are compared a run at a time; their boundaries need not match
+	return count == other.count && equal_runs(runs(first), runs(other.first));
+}
+
+// compare(tree)			//Orders two trees by their first differing key, then by size.
+template<class T, class Compare>
+inline int btree<T, Compare>::compare(const btree& other) const
+	{ return compare_runs(runs(first), runs(other.first)); }
+
+// hash()					//Returns a hash of the keys in order.
+template<class T, class Compare>
+std::size_t btree<T, Compare>::hash() const
+{
+	sequence_hash<T> h;
+	for(const Leaf* l = first; l != nullptr; l = l->next)
+		h.add(l->at(0), l->n);
+	return h.value();
+}
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::const_iterator btree<T, Compare>::begin() const
+	{ return const_iterator(this, first, 0); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::const_iterator btree<T, Compare>::end() const
+	{ return const_iterator(this, nullptr, 0); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::const_iterator btree<T, Compare>::cbegin() const
+	{ return begin(); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::const_iterator btree<T, Compare>::cend() const
+	{ return end(); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::preorder_iterator btree<T, Compare>::preorder_begin() const
+{
+	preorder_iterator it(root);
+	it.path.reserve(levels);
+	return it;
+}
 
-/*
-class Btree
-{
-	private:
-		Node *root;
-	public:
-		btree();
-		void insert();
-		static Node* search();
-		void remove();
-		void clear();
-		static void display(Node *root) ;
-		static void deltree(Node *root) ;
-		~btree();
-} ;*/
\ No newline at end of file
+template<class T, class Compare>
+inline typename btree<T, Compare>::preorder_iterator btree<T, Compare>::preorder_end() const
+	{ return preorder_iterator(); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::levelorder_iterator btree<T, Compare>::levelorder_begin() const
+	{ return levelorder_iterator(root); }
+
+template<class T, class Compare>
+inline typename btree<T, Compare>::levelorder_iterator btree<T, Compare>::levelorder_end() const
+	{ return levelorder_iterator(); }
+
+// dump(os)					//Writes each node's keys on its own line, pre-order, two spaces per level.
+template<class T, class Compare>
+std::ostream& btree<T, Compare>::dump(std::ostream& os) const
+{
+	for(preorder_iterator it = preorder_begin(); it != preorder_end(); ++it)
+	{
+		node_view v = *it;
+		for(size_type d = 0; d < v.depth(); ++d) os << "  ";
+		os << '[';
+		for(size_type k = 0; k < v.size(); ++k)
+			os << (k == 0 ? "" : " ") << v.key(k);
+		os << "]\n";
+	}
+	return os;
+}
+
+// to_string()				//Returns the keys of this tree in order, space separated.
+template<class T, class Compare>
+std::string btree<T, Compare>::to_string() const
+	{ return format_string(begin(), end()); }
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef BTREE_IO_H
+#define BTREE_IO_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "btree.h"
+#include "slist/binary_io.h"
+#include "slist/mapped_file.h"
+
+// Binary snapshots of a btree (magic "BTRE"). After the common header
+// come the node capacities the tree was built with, its height and its
+// node count, then every node in pre-order:
+//
+//   u8 leaf, u8 0, u16 keys, then the keys
+//
+// Trivially copyable keys are written as one raw block per node. Loading a
+// snapshot made with the same capacities rebuilds the very same nodes, so
+// there are no comparisons to re-sort and no splits; a snapshot from a
+// build with other capacities is read back through bulk_load instead.
+
+constexpr std::uint16_t btree_binary_version = 1;
+
+namespace btree_io_detail
+{
+	// read_keys(r, dst, n)	//Constructs n keys at dst from r, counting each into built.
+	template<class E>
+	bool read_keys(binary_reader& r, E* dst, std::size_t n, std::uint16_t& built)
+	{
+		typedef binary_traits<E> traits;
+
+		if constexpr(traits::raw)
+		{
+			const char* p = (n <= r.remaining() / sizeof(E)) ? r.take(n * sizeof(E)) : nullptr;
+			if(p == nullptr) return false;
+			std::memcpy(static_cast<void*>(dst), p, n * sizeof(E));
+			built = std::uint16_t(n);
+			return true;
+		}
+		else
+		{
+			for(; built < n; ++built)
+			{
+				E v;
+				if(!traits::read(r, v)) return false;
+				::new(static_cast<void*>(dst + built)) E(std::move(v));
+			}
+			return true;
+		}
+	}
+
+	// keys_within(comp, p, n, lo, hi, leaf)	//True if p[0, n) ascends strictly inside the range [lo, hi).
+	// A leaf may start at lo, the separator copied from it; an inner node's
+	// first child holds keys from lo up to its first separator, so that
+	// separator must lie above lo. Null bounds are open.
+	template<class E, class C>
+	bool keys_within(const C& comp, const E* p, std::size_t n, const E* lo, const E* hi, bool leaf)
+	{
+		if(lo != nullptr && (leaf ? comp(p[0], *lo) : !comp(*lo, p[0]))) return false;
+		if(hi != nullptr && !comp(p[n - 1], *hi)) return false;
+		for(std::size_t k = 1; k < n; ++k)
+			if(!comp(p[k - 1], p[k])) return false;
+		return true;
+	}
+}
+
+// save_binary(os, tree)	//Writes tree to os; returns false if the stream failed.
+template<class E, class C>
+bool save_binary(std::ostream& os, const btree<E, C>& tree)
+{
+	typedef binary_traits<E> traits;
+	typedef btree<E, C> tree_type;
+
+	binary_writer w(os);
+	write_header(w, "BTRE", btree_binary_version, traits::raw ? sizeof(E) : 0, 0, tree.size());
+	w.put(std::uint32_t(tree_type::leaf_capacity));
+	w.put(std::uint32_t(tree_type::inner_capacity));
+	w.put(std::uint64_t(tree.height()));
+	w.put(std::uint64_t(tree.node_count()));
+
+	for(typename tree_type::preorder_iterator it = tree.preorder_begin(); it != tree.preorder_end(); ++it)
+	{
+		typename tree_type::node_view v = *it;
+		w.put(std::uint8_t(v.is_leaf()));
+		w.put(std::uint8_t(0));
+		w.put(std::uint16_t(v.size()));
+		if constexpr(traits::raw)
+			w.write(&v.key(0), v.size() * sizeof(E));
+		else
+			for(std::size_t i = 0; i < v.size(); ++i)
+				traits::write(w, v.key(i));
+	}
+	w.flush();
+	return w.good();
+}
+
+// save_binary(path, tree)	//Writes tree to a new file at path.
+template<class E, class C>
+bool save_binary(const char* path, const btree<E, C>& tree)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	return out && save_binary(out, tree) && out.flush();
+}
+
+// load_binary(first, last, tree)	//Replaces tree with the snapshot in [first, last); false if it is not one.
+// Every node is checked against the header before it is linked in, and
+// its keys must ascend and fall within the range its parent's separators
+// route to it, so a damaged snapshot is refused rather than loaded as a
+// broken tree. On failure tree is left empty.
+template<class E, class C>
+bool load_binary(const char* first, const char* last, btree<E, C>& tree)
+{
+	typedef binary_traits<E> traits;
+	typedef btree<E, C> tree_type;
+	typedef typename tree_type::Node Node;
+	typedef typename tree_type::Leaf Leaf;
+	typedef typename tree_type::Inner Inner;
+	typedef typename tree_type::Step Step;
+
+	tree.clear();
+	binary_reader r(first, last);
+	binary_header h;
+	std::uint32_t leaf_cap, inner_cap;
+	std::uint64_t levels, nodes;
+	if(!read_header(r, "BTRE", btree_binary_version, traits::raw ? sizeof(E) : 0, h)
+		|| !r.get(leaf_cap) || !r.get(inner_cap) || !r.get(levels) || !r.get(nodes))
+		return false;
+	if(levels > tree_type::max_height || (levels == 0) != (nodes == 0) || (nodes == 0) != (h.count == 0))
+		return false;
+
+	std::uint8_t leaf, pad;
+	std::uint16_t n;
+
+	// other capacities: the node shapes cannot be kept, but the leaves
+	// still hold every key in order
+	if(leaf_cap != tree_type::leaf_capacity || inner_cap != tree_type::inner_capacity)
+	{
+		std::vector<E> keys;
+		if(traits::raw && h.count <= r.remaining() / sizeof(E)) keys.reserve(h.count);
+
+		for(std::uint64_t i = 0; i < nodes; ++i)
+		{
+			if(!r.get(leaf) || !r.get(pad) || !r.get(n)) return false;
+			for(std::uint16_t k = 0; k < n; ++k)
+			{
+				E v;
+				if(!traits::read(r, v)) return false;
+				if(leaf) keys.push_back(std::move(v));
+			}
+		}
+
+		tree.bulk_load(keys.begin(), keys.end());
+		if(tree.size() != h.count)
+		{
+			tree.clear();
+			return false;
+		}
+		return true;
+	}
+
+	// the inner nodes above the next node and the child slot it fills
+	std::vector<Step> path;
+	// the key range each of them covers: [lo, hi), null for unbounded
+	std::vector<std::pair<const E*, const E*>> range;
+	Leaf* prev = nullptr;
+	bool good = true;
+
+	for(std::uint64_t i = 0; good && i < nodes; ++i)
+	{
+		if(!r.get(leaf) || !r.get(pad) || !r.get(n))
+		{
+			good = false;
+			break;
+		}
+
+		while(!path.empty() && path.back().idx > path.back().node->n)
+		{
+			path.pop_back();
+			range.pop_back();
+		}
+		// a second root: the first subtree was already complete
+		if(path.empty() && tree.root != nullptr)
+		{
+			good = false;
+			break;
+		}
+
+		// leaves all sit at the bottom level, and no node is empty or overfull
+		const bool at_bottom = path.size() + 1 == levels;
+		if(bool(leaf) != at_bottom || n == 0 || n > (leaf ? tree_type::leaf_capacity : tree_type::inner_capacity))
+		{
+			good = false;
+			break;
+		}
+
+		// the range the parent routes to this child
+		const E* lo = nullptr;
+		const E* hi = nullptr;
+		if(!path.empty())
+		{
+			const Step& up = path.back();
+			lo = up.idx > 0 ? up.node->at(up.idx - 1) : range.back().first;
+			hi = up.idx < up.node->n ? up.node->at(up.idx) : range.back().second;
+		}
+
+		// link the node in before filling it, so clear() frees it if the
+		// keys turn out to be short
+		Node* x;
+		if(leaf)
+			x = tree.make_leaf();
+		else
+		{
+			Inner* in = tree.make_inner();
+			for(std::size_t k = 0; k <= tree_type::inner_capacity; ++k) in->child[k] = nullptr;
+			x = in;
+		}
+		if(path.empty())
+			tree.root = x;
+		else
+			path.back().node->child[path.back().idx++] = x;
+
+		if(!leaf)
+		{
+			Inner* in = static_cast<Inner*>(x);
+			good = btree_io_detail::read_keys(r, in->at(0), n, in->n)
+				&& btree_io_detail::keys_within(tree.comp, in->at(0), n, lo, hi, false);
+			path.push_back(Step{in, 0});
+			range.emplace_back(lo, hi);
+			continue;
+		}
+
+		Leaf* l = static_cast<Leaf*>(x);
+		l->prev = prev;
+		if(prev != nullptr) prev->next = l;
+		else tree.first = l;
+		tree.last = prev = l;
+
+		good = btree_io_detail::read_keys(r, l->at(0), n, l->n);
+		if(good && l->prev != nullptr && !tree.comp(*l->prev->at(l->prev->n - 1), *l->at(0)))
+			good = false;
+		good = good && btree_io_detail::keys_within(tree.comp, l->at(0), n, lo, hi, true);
+		tree.count += l->n;
+	}
+
+	while(good && !path.empty() && path.back().idx > path.back().node->n)
+		path.pop_back();
+	// every inner node got all its children, and the keys add up
+	if(!good || !path.empty() || tree.count != h.count)
+	{
+		tree.clear();
+		return false;
+	}
+
+	tree.levels = levels;
+	return true;
+}
+
+// load_binary(path, tree)	//Replaces tree with the snapshot in the file at path, read through a mapping.
+template<class E, class C>
+bool load_binary(const char* path, btree<E, C>& tree)
+{
+	mapped_file file(path);
+	if(!file.is_open())
+	{
+		tree.clear();
+		return false;
+	}
+	return load_binary(file.begin(), file.end(), tree);
+}
+
+#endif
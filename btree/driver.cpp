@@ -1,8 +1,89 @@
-
 #include "btree.h"
+#include "btree_io.h"
+#include "slist/slist.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// a key wide enough that inner nodes hold only four separators
+struct wide_key
+{
+	int v;
+	char pad[124];
+
+	bool operator<(const wide_key& rhs) const { return v < rhs.v; }
+	bool operator==(const wide_key& rhs) const { return v == rhs.v; }
+};
 
 int main()
 {
 	btree<int> source;
+
+	int limit;
+	std::cin >> limit;
+
+	for(int i = 0; i < limit; ++i)
+	{
+		source.insert(std::rand() % (limit * 2 + 1));
+	}
+
+	btree<int> source_cpy(source);
+
+	for(int i = 0; i < limit; i += 2)
+	{
+		source_cpy.erase(i);
+	}
+
+	std::cout << source << std::endl;
+	std::cout << source_cpy << std::endl;
+
+	btree<int>::const_iterator it = source.lower_bound(limit);
+	if(it != source.end())
+	{
+		std::cout << "first key >= " << limit << ": " << *it << std::endl;
+	}
+
+	std::cout << source.size() << " keys, " << source.height() << " levels" << std::endl;
+
+	slist<int> sorted;
+	for(int i = 0; i < limit; ++i)
+	{
+		sorted.push_back(std::rand() % (limit * 2 + 1));
+	}
+	sorted.sort();
+
+	btree<int> packed(sorted_unique, sorted.begin(), sorted.end(), 0.9);
+	std::cout << packed << std::endl;
+
+	std::ostringstream snapshot;
+	save_binary(snapshot, packed);
+	std::string bytes = snapshot.str();
+
+	btree<int> restored;
+	if(load_binary(bytes.data(), bytes.data() + bytes.size(), restored))
+	{
+		std::cout << "snapshot of " << bytes.size() << " bytes restored "
+			<< (restored == packed ? "intact" : "damaged") << std::endl;
+	}
+
+	// a low fill once built inner nodes with a single child, which neither
+	// reloaded from a snapshot nor survived being erased to empty
+	std::vector<wide_key> wide(12, wide_key{});
+	for(int i = 0; i < 12; ++i) wide[i].v = i;
+	btree<wide_key> sparse(sorted_unique, wide.begin(), wide.end(), 0.5);
+
+	std::ostringstream wide_snapshot;
+	save_binary(wide_snapshot, sparse);
+	std::string wide_bytes = wide_snapshot.str();
+	btree<wide_key> wide_restored;
+	bool reloaded = load_binary(wide_bytes.data(), wide_bytes.data() + wide_bytes.size(), wide_restored)
+		&& wide_restored == sparse;
+
+	for(int i = 11; i >= 0; --i) sparse.erase(wide[i]);
+	std::cout << "sparse wide-key tree " << (reloaded ? "reloaded" : "not reloaded")
+		<< ", " << sparse.size() << " keys left after erasing" << std::endl;
+
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,131 @@
+#ifndef AIRPORT_H
+#define AIRPORT_H
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "slist.h"
+
+struct Airport
+{
+	char code[5];
+	double longitude;
+	double latitude;
+};
+
+constexpr double airport_pi = 3.14159265358979323846;
+constexpr double earth_radius_km = 6371.0;
+
+// This function converts decimal degrees to radians
+inline double deg2rad(double deg) {
+  return (deg * airport_pi / 180);
+}
+
+//  This function converts radians to decimal degrees
+inline double rad2deg(double rad) {
+  return (rad * 180 / airport_pi);
+}
+
+/**
+ * Returns the distance between two points on the Earth.
+ * Direct translation from http://en.wikipedia.org/wiki/Haversine_formula
+ * @param lat1d Latitude of the first point in degrees
+ * @param lon1d Longitude of the first point in degrees
+ * @param lat2d Latitude of the second point in degrees
+ * @param lon2d Longitude of the second point in degrees
+ * @return The distance between the two points in kilometers
+ */
+inline double distanceEarth(double lat1d, double lon1d, double lat2d, double lon2d) {
+  double lat1r, lon1r, lat2r, lon2r, u, v;
+  lat1r = deg2rad(lat1d);
+  lon1r = deg2rad(lon1d);
+  lat2r = deg2rad(lat2d);
+  lon2r = deg2rad(lon2d);
+  u = std::sin((lat2r - lat1r)/2);
+  v = std::sin((lon2r - lon1r)/2);
+  return 2.0 * earth_radius_km * std::asin(std::sqrt(u * u + std::cos(lat1r) * std::cos(lat2r) * v * v));
+}
+
+// Parses "code,latitude,longitude" rows in [first, last) and calls
+// emit(const Airport&) for each. Rows whose coordinates are not numbers,
+// the header among them, are skipped. Codes longer than four characters
+// are truncated to fit Airport::code. Returns the number of rows emitted.
+template<class Emit>
+std::size_t parse_airports(const char* first, const char* last, Emit emit)
+{
+	std::size_t rows = 0;
+
+	while(first < last)
+	{
+		const char* eol = static_cast<const char*>(std::memchr(first, '\n', last - first));
+		if(eol == nullptr) eol = last;
+		const char* line_end = (eol > first && eol[-1] == '\r') ? eol - 1 : eol;
+
+		const char* c1 = static_cast<const char*>(std::memchr(first, ',', line_end - first));
+		const char* c2 = c1 ? static_cast<const char*>(std::memchr(c1 + 1, ',', line_end - c1 - 1)) : nullptr;
+
+		if(c2 != nullptr)
+		{
+			Airport a;
+			std::from_chars_result lat = std::from_chars(c1 + 1, c2, a.latitude);
+			std::from_chars_result lon = std::from_chars(c2 + 1, line_end, a.longitude);
+
+			if(lat.ec == std::errc() && lon.ec == std::errc())
+			{
+				std::size_t n = c1 - first;
+				if(n > sizeof(a.code) - 1) n = sizeof(a.code) - 1;
+				std::memcpy(a.code, first, n);
+				a.code[n] = '\0';
+
+				emit(a);
+				++rows;
+			}
+		}
+
+		first = eol + 1;
+	}
+
+	return rows;
+}
+
+// Loads the airport file into a contiguous array. Returns false if the file
+// cannot be opened; ms, if given, receives the load time in milliseconds.
+inline bool load_airports(const char* path, std::vector<Airport>& out, double* ms = nullptr)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	mapped_file file(path);
+	if(!file.is_open()) return false;
+
+	// rows run well over 16 bytes, so this reserve covers the whole file in one go
+	out.reserve(out.size() + file.size() / 16);
+	parse_airports(file.begin(), file.end(), [&](const Airport& a) { out.push_back(a); });
+
+	if(ms != nullptr)
+		*ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+// Loads the airport file into a list whose nodes come from its slab pool.
+template<class Alloc, bool Doubly>
+bool load_airports(const char* path, slist<Airport, Alloc, Doubly>& out, double* ms = nullptr)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	mapped_file file(path);
+	if(!file.is_open()) return false;
+
+	parse_airports(file.begin(), file.end(), [&](const Airport& a) { out.push_back(a); });
+
+	if(ms != nullptr)
+		*ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+#endif
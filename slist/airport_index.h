@@ -0,0 +1,275 @@
+#ifndef AIRPORT_INDEX_H
+#define AIRPORT_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "airport.h"
+
+// one query result: the airport's position in the indexed array and its distance
+struct airport_hit
+{
+	double km;
+	std::size_t index;
+
+	bool operator<(const airport_hit& rhs) const
+		{ return km < rhs.km || (km == rhs.km && index < rhs.index); }
+};
+
+// k-d tree over airports placed on the unit sphere. Straight-line (chord)
+// distance between unit vectors grows with great-circle distance,
+//
+//   chord = 2 sin(d / 2R)
+//
+// so pruning on squared chord lengths in 3D is exact: no airport the tree
+// skips could have been closer. Only the candidates that survive are
+// handed to distanceEarth. Queries take degrees and return kilometres,
+// like distanceEarth; indices refer to the array the index was built from.
+class airport_index
+{
+public:
+	typedef std::size_t size_type;
+
+	// points per leaf; a leaf is scanned linearly
+	static const size_type leaf_size = 8;
+
+	airport_index() {}
+	explicit airport_index(const std::vector<Airport>& airports) { build(airports); }
+
+	void build(const std::vector<Airport>&);
+
+	size_type size() const { return pts.size(); }
+	bool empty() const { return pts.empty(); }
+
+	// the k airports nearest to (lat, lon), nearest first
+	std::vector<airport_hit> nearest(double lat, double lon, size_type k) const;
+
+	// every airport within km of (lat, lon), nearest first
+	std::vector<airport_hit> within(double lat, double lon, double km) const;
+
+private:
+	struct Point
+	{
+		double v[3];
+		double lat;
+		double lon;
+		size_type index;
+	};
+
+	// inner nodes split [begin, end) at mid on axis; leaves have axis == 3
+	struct Node
+	{
+		std::uint32_t begin;
+		std::uint32_t end;
+		std::uint32_t left;
+		std::uint32_t right;
+		double split;
+		std::uint8_t axis;
+	};
+
+	// candidate subtree on the query stack with a lower bound on its chord^2
+	struct Pending
+	{
+		std::uint32_t node;
+		double bound;
+	};
+
+	std::uint32_t build_node(std::uint32_t begin, std::uint32_t end);
+
+	static void unit(double lat, double lon, double out[3]);
+	static double chord2(const double a[3], const double b[3]);
+
+	std::vector<Point> pts;
+	std::vector<Node> nodes;
+};
+
+// build(airports)			//Rebuilds the tree over the given airports.
+inline void airport_index::build(const std::vector<Airport>& airports)
+{
+	pts.clear();
+	nodes.clear();
+	pts.reserve(airports.size());
+	for(size_type i = 0; i < airports.size(); ++i)
+	{
+		Point p;
+		unit(airports[i].latitude, airports[i].longitude, p.v);
+		p.lat = airports[i].latitude;
+		p.lon = airports[i].longitude;
+		p.index = i;
+		pts.push_back(p);
+	}
+
+	if(!pts.empty())
+	{
+		nodes.reserve(2 * pts.size() / leaf_size + 1);
+		build_node(0, pts.size());
+	}
+}
+
+// build_node(begin, end)	//Splits [begin, end) on its widest axis; returns the node's slot.
+inline std::uint32_t airport_index::build_node(std::uint32_t begin, std::uint32_t end)
+{
+	std::uint32_t id = nodes.size();
+	nodes.push_back(Node{begin, end, 0, 0, 0.0, 3});
+	if(end - begin <= leaf_size) return id;
+
+	double lo[3] = { 2, 2, 2 };
+	double hi[3] = { -2, -2, -2 };
+	for(std::uint32_t i = begin; i < end; ++i)
+		for(int a = 0; a < 3; ++a)
+		{
+			lo[a] = std::min(lo[a], pts[i].v[a]);
+			hi[a] = std::max(hi[a], pts[i].v[a]);
+		}
+
+	std::uint8_t axis = 0;
+	for(std::uint8_t a = 1; a < 3; ++a)
+		if(hi[a] - lo[a] > hi[axis] - lo[axis]) axis = a;
+
+	std::uint32_t mid = begin + (end - begin) / 2;
+	std::nth_element(pts.begin() + begin, pts.begin() + mid, pts.begin() + end,
+		[axis](const Point& lhs, const Point& rhs) { return lhs.v[axis] < rhs.v[axis]; });
+
+	// the children reorder their halves, so take the split value first; they
+	// may also reallocate nodes, so fill this one in by index afterwards
+	double split = pts[mid].v[axis];
+	std::uint32_t left = build_node(begin, mid);
+	std::uint32_t right = build_node(mid, end);
+	nodes[id].left = left;
+	nodes[id].right = right;
+	nodes[id].split = split;
+	nodes[id].axis = axis;
+	return id;
+}
+
+// nearest(lat, lon, k)		//Returns the k airports closest to the point.
+inline std::vector<airport_hit> airport_index::nearest(double lat, double lon, size_type k) const
+{
+	std::vector<airport_hit> out;
+	if(k == 0 || pts.empty()) return out;
+	if(k > pts.size()) k = pts.size();
+
+	double q[3];
+	unit(lat, lon, q);
+
+	// max-heap on chord^2 of the best k so far; index is a position in pts,
+	// and ties go to the lower original index, as a linear scan would
+	std::vector<airport_hit> best;
+	auto worse = [this](const airport_hit& lhs, const airport_hit& rhs)
+		{ return lhs.km < rhs.km || (lhs.km == rhs.km && pts[lhs.index].index < pts[rhs.index].index); };
+	best.reserve(k);
+	std::vector<Pending> stack;
+	stack.push_back(Pending{0, 0.0});
+
+	while(!stack.empty())
+	{
+		Pending p = stack.back();
+		stack.pop_back();
+		if(best.size() == k && p.bound > best.front().km) continue;
+
+		const Node& n = nodes[p.node];
+		if(n.axis == 3)
+		{
+			for(std::uint32_t i = n.begin; i < n.end; ++i)
+			{
+				double d = chord2(q, pts[i].v);
+				if(best.size() < k)
+				{
+					best.push_back(airport_hit{d, i});
+					std::push_heap(best.begin(), best.end(), worse);
+				}
+				else if(worse(airport_hit{d, i}, best.front()))
+				{
+					std::pop_heap(best.begin(), best.end(), worse);
+					best.back() = airport_hit{d, i};
+					std::push_heap(best.begin(), best.end(), worse);
+				}
+			}
+			continue;
+		}
+
+		// visit the near side first; the far side is at least diff^2 away
+		double diff = q[n.axis] - n.split;
+		std::uint32_t near = diff < 0 ? n.left : n.right;
+		std::uint32_t far = diff < 0 ? n.right : n.left;
+		stack.push_back(Pending{far, std::max(p.bound, diff * diff)});
+		stack.push_back(Pending{near, p.bound});
+	}
+
+	out.reserve(best.size());
+	for(const airport_hit& h: best)
+	{
+		const Point& pt = pts[h.index];
+		out.push_back(airport_hit{distanceEarth(lat, lon, pt.lat, pt.lon), pt.index});
+	}
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+// within(lat, lon, km)		//Returns every airport no farther than km from the point.
+inline std::vector<airport_hit> airport_index::within(double lat, double lon, double km) const
+{
+	std::vector<airport_hit> out;
+	if(km < 0 || pts.empty()) return out;
+
+	double q[3];
+	unit(lat, lon, q);
+
+	// chord^2 bound for the radius, with slack so rounding never drops a
+	// boundary airport; distanceEarth makes the final call
+	double half = std::min(km / earth_radius_km, airport_pi) / 2;
+	double limit = 4 * std::sin(half) * std::sin(half) * (1 + 1e-9) + 1e-12;
+
+	std::vector<Pending> stack;
+	stack.push_back(Pending{0, 0.0});
+
+	while(!stack.empty())
+	{
+		Pending p = stack.back();
+		stack.pop_back();
+		if(p.bound > limit) continue;
+
+		const Node& n = nodes[p.node];
+		if(n.axis == 3)
+		{
+			for(std::uint32_t i = n.begin; i < n.end; ++i)
+				if(chord2(q, pts[i].v) <= limit)
+				{
+					double d = distanceEarth(lat, lon, pts[i].lat, pts[i].lon);
+					if(d <= km) out.push_back(airport_hit{d, pts[i].index});
+				}
+			continue;
+		}
+
+		double diff = q[n.axis] - n.split;
+		std::uint32_t near = diff < 0 ? n.left : n.right;
+		std::uint32_t far = diff < 0 ? n.right : n.left;
+		stack.push_back(Pending{far, std::max(p.bound, diff * diff)});
+		stack.push_back(Pending{near, p.bound});
+	}
+
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+inline void airport_index::unit(double lat, double lon, double out[3])
+{
+	double la = deg2rad(lat);
+	double lo = deg2rad(lon);
+	out[0] = std::cos(la) * std::cos(lo);
+	out[1] = std::cos(la) * std::sin(lo);
+	out[2] = std::sin(la);
+}
+
+inline double airport_index::chord2(const double a[3], const double b[3])
+{
+	double dx = a[0] - b[0];
+	double dy = a[1] - b[1];
+	double dz = a[2] - b[2];
+	return dx * dx + dy * dy + dz * dz;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef AIRPORT_PAIRS_H
+#define AIRPORT_PAIRS_H
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "airport_index.h"
+#include "airport_store.h"
+
+// Whole-set distance work over an airport_store: every unordered pair is
+// visited once. The n x n triangle is cut into square tiles of tile x tile
+// airports, so the two column blocks a tile touches stay in cache, and
+// worker threads claim tiles from a shared counter. Each worker reduces
+// into its own state; the states are merged once all tiles are done, so
+// the hot loop takes no locks and shares no cache lines.
+//
+// threads == 0 means one per hardware thread.
+
+// an unordered pair of airports (first < second) and their distance in km
+struct airport_pair
+{
+	double km;
+	std::size_t first;
+	std::size_t second;
+};
+
+struct airport_extremes
+{
+	airport_pair farthest;
+	airport_pair closest;
+	// nearest[i] is airport i's nearest other airport
+	std::vector<airport_hit> nearest;
+};
+
+namespace airport_pairs_detail
+{
+	const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+	// chord^2 pair; ties go to the lexicographically smaller (i, j) so the
+	// result does not depend on how the tiles were shared out
+	struct candidate
+	{
+		double c2;
+		std::size_t i;
+		std::size_t j;
+	};
+
+	inline bool earlier(const candidate& lhs, const candidate& rhs)
+		{ return lhs.i < rhs.i || (lhs.i == rhs.i && lhs.j < rhs.j); }
+
+	inline void keep_max(candidate& best, const candidate& c)
+	{
+		if(c.c2 > best.c2 || (c.c2 == best.c2 && earlier(c, best))) best = c;
+	}
+
+	inline void keep_min(candidate& best, const candidate& c)
+	{
+		if(c.c2 < best.c2 || (c.c2 == best.c2 && earlier(c, best))) best = c;
+	}
+
+	inline void keep_nearest(std::pair<double, std::size_t>& best, double c2, std::size_t j)
+	{
+		if(c2 < best.first || (c2 == best.first && j < best.second)) best = std::make_pair(c2, j);
+	}
+
+	// (row block, column block) pairs with column >= row, in claim order
+	inline std::vector<std::pair<std::size_t, std::size_t>> tiles(std::size_t n, std::size_t tile)
+	{
+		std::vector<std::pair<std::size_t, std::size_t>> out;
+		for(std::size_t bi = 0; bi < n; bi += tile)
+			for(std::size_t bj = bi; bj < n; bj += tile)
+				out.push_back(std::make_pair(bi, bj));
+		return out;
+	}
+
+	// runs work(worker, row block, column block) over every tile on threads workers
+	template<class Work>
+	void run_tiles(std::size_t n, std::size_t tile, unsigned threads, Work work)
+	{
+		std::vector<std::pair<std::size_t, std::size_t>> todo = tiles(n, tile);
+		std::atomic<std::size_t> next(0);
+
+		auto worker = [&](unsigned w)
+		{
+			for(std::size_t t = next.fetch_add(1, std::memory_order_relaxed); t < todo.size();
+				t = next.fetch_add(1, std::memory_order_relaxed))
+				work(w, todo[t].first, todo[t].second);
+		};
+
+		std::vector<std::thread> pool;
+		for(unsigned w = 1; w < threads; ++w)
+			pool.emplace_back(worker, w);
+		worker(0);
+		for(std::thread& t: pool) t.join();
+	}
+
+	inline unsigned thread_count(unsigned threads)
+	{
+		if(threads == 0) threads = std::thread::hardware_concurrency();
+		return threads == 0 ? 1 : threads;
+	}
+}
+
+// all_pairs_extremes(store, threads, tile)	//Finds the farthest and closest pairs and every airport's nearest neighbour.
+inline airport_extremes all_pairs_extremes(const airport_store& store, unsigned threads = 0, std::size_t tile = 256)
+{
+	using namespace airport_pairs_detail;
+
+	const std::size_t n = store.size();
+	const double* x = store.xs();
+	const double* y = store.ys();
+	const double* z = store.zs();
+	threads = thread_count(threads);
+	if(tile == 0) tile = 256;
+
+	struct alignas(64) partial
+	{
+		candidate far;
+		candidate close;
+		std::vector<std::pair<double, std::size_t>> nearest;
+	};
+
+	std::vector<partial> parts(threads);
+	for(partial& p: parts)
+	{
+		p.far = candidate{ -1.0, none, none };
+		p.close = candidate{ std::numeric_limits<double>::infinity(), none, none };
+		p.nearest.assign(n, std::make_pair(std::numeric_limits<double>::infinity(), none));
+	}
+
+	run_tiles(n, tile, threads, [&](unsigned w, std::size_t bi, std::size_t bj)
+	{
+		partial& p = parts[w];
+		const std::size_t iend = std::min(bi + tile, n);
+		const std::size_t jend = std::min(bj + tile, n);
+
+		for(std::size_t i = bi; i < iend; ++i)
+		{
+			const double xi = x[i], yi = y[i], zi = z[i];
+			std::pair<double, std::size_t> row = p.nearest[i];
+			candidate far = p.far;
+			candidate close = p.close;
+
+			for(std::size_t j = (bi == bj ? i + 1 : bj); j < jend; ++j)
+			{
+				double dx = x[j] - xi;
+				double dy = y[j] - yi;
+				double dz = z[j] - zi;
+				double c2 = dx * dx + dy * dy + dz * dz;
+
+				keep_max(far, candidate{c2, i, j});
+				keep_min(close, candidate{c2, i, j});
+				keep_nearest(row, c2, j);
+				keep_nearest(p.nearest[j], c2, i);
+			}
+
+			p.nearest[i] = row;
+			p.far = far;
+			p.close = close;
+		}
+	});
+
+	// merge the workers' partial results
+	candidate far = parts[0].far;
+	candidate close = parts[0].close;
+	std::vector<std::pair<double, std::size_t>>& nearest = parts[0].nearest;
+	for(unsigned w = 1; w < threads; ++w)
+	{
+		keep_max(far, parts[w].far);
+		keep_min(close, parts[w].close);
+		for(std::size_t i = 0; i < n; ++i)
+			keep_nearest(nearest[i], parts[w].nearest[i].first, parts[w].nearest[i].second);
+	}
+
+	airport_extremes out;
+	out.farthest = airport_pair{ far.i == none ? 0.0 : store.distance(far.i, far.j), far.i, far.j };
+	out.closest = airport_pair{ close.i == none ? 0.0 : store.distance(close.i, close.j), close.i, close.j };
+	out.nearest.reserve(n);
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		std::size_t j = nearest[i].second;
+		out.nearest.push_back(airport_hit{ j == none ? 0.0 : store.distance(i, j), j });
+	}
+	return out;
+}
+
+// distance_matrix(store, out, threads, tile)	//Fills out[i * n + j] with the km between airports i and j.
+// out must hold size() * size() doubles: about 1.4 GB for the full airport file.
+inline void distance_matrix(const airport_store& store, double* out, unsigned threads = 0, std::size_t tile = 256)
+{
+	using namespace airport_pairs_detail;
+
+	const std::size_t n = store.size();
+	const double* x = store.xs();
+	const double* y = store.ys();
+	const double* z = store.zs();
+	threads = thread_count(threads);
+	if(tile == 0) tile = 256;
+
+	run_tiles(n, tile, threads, [&](unsigned, std::size_t bi, std::size_t bj)
+	{
+		const std::size_t iend = std::min(bi + tile, n);
+		const std::size_t jend = std::min(bj + tile, n);
+
+		// each row of the tile in one vector sweep, then mirror it below the diagonal
+		for(std::size_t i = bi; i < iend; ++i)
+		{
+			double* row = out + i * n;
+			store.sweep(x[i], y[i], z[i], bj, jend, row + bj);
+			if(bi == bj) row[i] = 0.0;
+		}
+		for(std::size_t i = bi; i < iend; ++i)
+			for(std::size_t j = (bi == bj ? i + 1 : bj); j < jend; ++j)
+				out[j * n + i] = out[i * n + j];
+	});
+}
+
+#endif
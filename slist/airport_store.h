@@ -0,0 +1,203 @@
+#ifndef AIRPORT_STORE_H
+#define AIRPORT_STORE_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include "airport.h"
+
+// Column store for airports: each field lives in its own contiguous array,
+// angles are kept in radians, and the trigonometry every distance needs is
+// done once per airport at insert time. Each airport is also kept as a
+// point on the unit sphere, which turns the haversine term into a plain
+// squared chord length:
+//
+//   sin^2(dlat/2) + cos(lat1) cos(lat2) sin^2(dlon/2) = |p1 - p2|^2 / 4
+//
+// so a one-to-many sweep is subtractions, multiplies and one asin per
+// target, which vectorizes.
+class airport_store
+{
+public:
+	typedef std::size_t size_type;
+
+	airport_store() {}
+
+	template<class InputIt>
+	airport_store(InputIt first, InputIt last)
+	{
+		for(; first != last; ++first) push_back(*first);
+	}
+
+	void reserve(size_type n)
+	{
+		codes.reserve(n);
+		lat.reserve(n);
+		lon.reserve(n);
+		cos_lat.reserve(n);
+		x.reserve(n);
+		y.reserve(n);
+		z.reserve(n);
+	}
+
+	void push_back(const Airport& a)
+	{
+		Code c;
+		std::memcpy(c.code, a.code, sizeof(c.code));
+		codes.push_back(c);
+
+		double la = deg2rad(a.latitude);
+		double lo = deg2rad(a.longitude);
+		lat.push_back(la);
+		lon.push_back(lo);
+		cos_lat.push_back(std::cos(la));
+		x.push_back(std::cos(la) * std::cos(lo));
+		y.push_back(std::cos(la) * std::sin(lo));
+		z.push_back(std::sin(la));
+	}
+
+	size_type size() const { return lat.size(); }
+	bool empty() const { return lat.empty(); }
+
+	const char* code(size_type i) const { return codes[i].code; }
+	// radians
+	double latitude(size_type i) const { return lat[i]; }
+	double longitude(size_type i) const { return lon[i]; }
+	double cos_latitude(size_type i) const { return cos_lat[i]; }
+
+	// raw columns of the unit-sphere points, for kernels of their own
+	const double* xs() const { return x.data(); }
+	const double* ys() const { return y.data(); }
+	const double* zs() const { return z.data(); }
+
+	// haversine distance in km between entries i and j, from cached trig
+	double distance(size_type i, size_type j) const
+	{
+		double u = std::sin((lat[j] - lat[i]) / 2);
+		double v = std::sin((lon[j] - lon[i]) / 2);
+		return 2.0 * earth_radius_km * std::asin(std::sqrt(u * u + cos_lat[i] * cos_lat[j] * v * v));
+	}
+
+	// out[k] = distance in km from entry i to entry k, for every k
+	void distances_from(size_type i, double* out) const
+		{ sweep(x[i], y[i], z[i], 0, size(), out); }
+
+	// out[k] = distance in km from (lat_deg, lon_deg) to entry k, for every k
+	void distances_from(double lat_deg, double lon_deg, double* out) const
+	{
+		double la = deg2rad(lat_deg);
+		double lo = deg2rad(lon_deg);
+		sweep(std::cos(la) * std::cos(lo), std::cos(la) * std::sin(lo), std::sin(la), 0, size(), out);
+	}
+
+	// out[k - first] = distance in km from the unit point (px, py, pz) to entry k, k in [first, last)
+	void sweep(double px, double py, double pz, size_type first, size_type last, double* out) const;
+
+private:
+	struct Code { char code[sizeof(Airport::code)]; };
+
+	std::vector<Code> codes;
+	std::vector<double> lat;
+	std::vector<double> lon;
+	std::vector<double> cos_lat;
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> z;
+};
+
+// Abramowitz & Stegun 4.4.46: asin(h) = pi/2 - sqrt(1 - h) * poly(h) on
+// [0, 1], absolute error under 2e-8 rad (about 0.13 m on the Earth).
+namespace airport_kernel
+{
+	constexpr double asin_c[8] = {
+		1.5707963050, -0.2145988016, 0.0889789874, -0.0501743046,
+		0.0308918810, -0.0170881256, 0.0066700901, -0.0012624911 };
+
+#if defined(__AVX2__)
+	inline __m256d asin_poly(__m256d h)
+	{
+		__m256d p = _mm256_set1_pd(asin_c[7]);
+		for(int k = 6; k >= 0; --k)
+			p = _mm256_fmadd_pd(p, h, _mm256_set1_pd(asin_c[k]));
+		__m256d r = _mm256_sqrt_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), h));
+		return _mm256_fnmadd_pd(r, p, _mm256_set1_pd(airport_pi / 2));
+	}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	inline __m128d asin_poly(__m128d h)
+	{
+		__m128d p = _mm_set1_pd(asin_c[7]);
+		for(int k = 6; k >= 0; --k)
+			p = _mm_add_pd(_mm_mul_pd(p, h), _mm_set1_pd(asin_c[k]));
+		__m128d r = _mm_sqrt_pd(_mm_sub_pd(_mm_set1_pd(1.0), h));
+		return _mm_sub_pd(_mm_set1_pd(airport_pi / 2), _mm_mul_pd(r, p));
+	}
+#endif
+}
+
+inline void airport_store::sweep(double px, double py, double pz, size_type first, size_type last, double* out) const
+{
+	const double* xp = x.data();
+	const double* yp = y.data();
+	const double* zp = z.data();
+	size_type k = first;
+
+#if defined(__AVX2__)
+	{
+		const __m256d vx = _mm256_set1_pd(px);
+		const __m256d vy = _mm256_set1_pd(py);
+		const __m256d vz = _mm256_set1_pd(pz);
+		const __m256d quarter = _mm256_set1_pd(0.25);
+		const __m256d one = _mm256_set1_pd(1.0);
+		const __m256d scale = _mm256_set1_pd(2.0 * earth_radius_km);
+
+		for(; k + 4 <= last; k += 4)
+		{
+			__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xp + k), vx);
+			__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(yp + k), vy);
+			__m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zp + k), vz);
+			__m256d c2 = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+			__m256d h = _mm256_min_pd(_mm256_sqrt_pd(_mm256_mul_pd(c2, quarter)), one);
+			_mm256_storeu_pd(out + (k - first), _mm256_mul_pd(scale, airport_kernel::asin_poly(h)));
+		}
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	{
+		const __m128d vx = _mm_set1_pd(px);
+		const __m128d vy = _mm_set1_pd(py);
+		const __m128d vz = _mm_set1_pd(pz);
+		const __m128d quarter = _mm_set1_pd(0.25);
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d scale = _mm_set1_pd(2.0 * earth_radius_km);
+
+		for(; k + 2 <= last; k += 2)
+		{
+			__m128d dx = _mm_sub_pd(_mm_loadu_pd(xp + k), vx);
+			__m128d dy = _mm_sub_pd(_mm_loadu_pd(yp + k), vy);
+			__m128d dz = _mm_sub_pd(_mm_loadu_pd(zp + k), vz);
+			__m128d c2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+			__m128d h = _mm_min_pd(_mm_sqrt_pd(_mm_mul_pd(c2, quarter)), one);
+			_mm_storeu_pd(out + (k - first), _mm_mul_pd(scale, airport_kernel::asin_poly(h)));
+		}
+	}
+#endif
+
+	// scalar fallback and remainder
+	for(; k < last; ++k)
+	{
+		double dx = xp[k] - px;
+		double dy = yp[k] - py;
+		double dz = zp[k] - pz;
+		double h = std::sqrt((dx * dx + dy * dy + dz * dz) * 0.25);
+		out[k - first] = 2.0 * earth_radius_km * std::asin(h < 1.0 ? h : 1.0);
+	}
+}
+
+#endif
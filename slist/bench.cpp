@@ -0,0 +1,261 @@
+// Microbenchmarks for slist and its variants.
+//
+// usage: bench [max_n] [--json]
+//
+// Every operation runs on lists of 1e3, 1e4 ... max_n elements (default
+// 1e6, up to 1e7) for 4, 32 and 128 byte payloads, on each node layout and
+// allocator. Each case repeats until it has run for at least 50 ms. One
+// result per line, as CSV (the default) or JSON objects, so runs from
+// different commits can be diffed or loaded side by side:
+//
+//   container,payload,op,n,reps,ns_per_op,ns_per_elem
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "slist.h"
+#include "uslist.h"
+
+// fixed-size payload; Bytes == sizeof
+template<std::size_t Bytes>
+struct payload
+{
+	payload(unsigned v = 0)
+	{
+		std::memset(bytes, 0, Bytes);
+		std::memcpy(bytes, &v, sizeof(v));
+	}
+
+	unsigned key() const
+	{
+		unsigned v;
+		std::memcpy(&v, bytes, sizeof(v));
+		return v;
+	}
+
+	bool operator==(const payload& rhs) const { return std::memcmp(bytes, rhs.bytes, Bytes) == 0; }
+	bool operator!=(const payload& rhs) const { return !(*this == rhs); }
+	bool operator<(const payload& rhs) const { return key() < rhs.key(); }
+
+	unsigned char bytes[Bytes];
+};
+
+template<std::size_t Bytes>
+std::ostream& operator<<(std::ostream& os, const payload<Bytes>& p)
+	{ return os << p.key(); }
+
+inline unsigned key_of(unsigned v) { return v; }
+template<std::size_t Bytes>
+inline unsigned key_of(const payload<Bytes>& p) { return p.key(); }
+
+// keeps results alive so the optimizer cannot drop the work
+static volatile unsigned long sink;
+
+static bool json = false;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static void report(const char* container, std::size_t bytes, const char* op,
+	std::size_t n, std::size_t reps, double ns)
+{
+	double per_op = ns / reps;
+	if(json)
+	{
+		std::cout << "{\"container\":\"" << container << "\",\"payload\":" << bytes
+			<< ",\"op\":\"" << op << "\",\"n\":" << n << ",\"reps\":" << reps
+			<< ",\"ns_per_op\":" << per_op << ",\"ns_per_elem\":" << per_op / n << "}\n";
+	}
+	else
+	{
+		std::cout << container << ',' << bytes << ',' << op << ',' << n << ',' << reps << ','
+			<< per_op << ',' << per_op / n << '\n';
+	}
+}
+
+// run body(timer) until 50 ms have been measured; body adds its own timed span
+template<class Body>
+static void measure(const char* container, std::size_t bytes, const char* op, std::size_t n, Body body)
+{
+	const double budget = 50e6;
+	double ns = 0;
+	std::size_t reps = 0;
+	while(ns < budget || reps == 0)
+	{
+		ns += body();
+		++reps;
+	}
+	report(container, bytes, op, n, reps, ns);
+}
+
+template<class Fn>
+static double timed(Fn fn)
+{
+	bench_clock::time_point start = bench_clock::now();
+	fn();
+	return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+}
+
+// slist inserts/erases in place at a fixed iterator; uslist hands back a fresh one
+template<class L, class It, class V>
+inline void insert_at(L& l, It& it, const V& v, std::true_type) { l.insert(it, v); }
+template<class L, class It, class V>
+inline void insert_at(L& l, It& it, const V& v, std::false_type) { it = l.insert(it, v); }
+template<class L, class It>
+inline void erase_at(L& l, It& it, std::true_type) { l.erase(it); }
+template<class L, class It>
+inline void erase_at(L& l, It& it, std::false_type) { it = l.erase(it); }
+
+template<class L>
+static L build(std::size_t n)
+{
+	L l;
+	for(std::size_t i = 0; i < n; ++i) l.push_back(typename L::value_type(i));
+	return l;
+}
+
+// operations every container supports
+template<class L, bool Slist>
+static void bench_common(const char* name, std::size_t n)
+{
+	typedef typename L::value_type V;
+	typedef std::integral_constant<bool, Slist> in_place;
+	const std::size_t bytes = sizeof(V);
+	const std::size_t edits = n < 1000 ? n : 1000;
+
+	measure(name, bytes, "push_back", n, [&]()
+	{
+		L l;
+		double ns = timed([&]() { for(std::size_t i = 0; i < n; ++i) l.push_back(V(i)); });
+		sink = sink + l.size();
+		return ns;
+	});
+
+	measure(name, bytes, "push_front", n, [&]()
+	{
+		L l;
+		double ns = timed([&]() { for(std::size_t i = 0; i < n; ++i) l.push_front(V(i)); });
+		sink = sink + l.size();
+		return ns;
+	});
+
+	L src = build<L>(n);
+
+	measure(name, bytes, "insert_middle", n, [&]()
+	{
+		L l(src);
+		typename L::iterator it = l.begin();
+		std::advance(it, n / 2);
+		return timed([&]() { for(std::size_t i = 0; i < edits; ++i) insert_at(l, it, V(i), in_place()); });
+	});
+
+	measure(name, bytes, "erase_middle", n, [&]()
+	{
+		L l(src);
+		typename L::iterator it = l.begin();
+		std::advance(it, n / 2 - edits / 2);
+		return timed([&]() { for(std::size_t i = 0; i < edits; ++i) erase_at(l, it, in_place()); });
+	});
+
+	measure(name, bytes, "traverse", n, [&]()
+	{
+		return timed([&]()
+		{
+			unsigned long sum = 0;
+			for(typename L::const_iterator it = src.cbegin(); it != src.cend(); ++it) sum += key_of(*it);
+			sink = sink + sum;
+		});
+	});
+
+	measure(name, bytes, "copy", n, [&]()
+	{
+		double ns;
+		{
+			L* l = nullptr;
+			ns = timed([&]() { l = new L(src); });
+			sink = sink + l->size();
+			delete l;
+		}
+		return ns;
+	});
+
+	measure(name, bytes, "size", n, [&]()
+		{ return timed([&]() { sink = sink + src.size(); }); });
+
+	L other(src);
+	measure(name, bytes, "equal", n, [&]()
+		{ return timed([&]() { sink = sink + (src == other); }); });
+
+	measure(name, bytes, "to_string", n, [&]()
+		{ return timed([&]() { sink = sink + src.to_string().size(); }); });
+}
+
+// relinking operations only slist has
+template<class L>
+static void bench_relink(const char* name, std::size_t n)
+{
+	typedef typename L::value_type V;
+	const std::size_t bytes = sizeof(V);
+
+	L l = build<L>(n);
+
+	measure(name, bytes, "reverse", n, [&]()
+		{ return timed([&]() { l.reverse(); }); });
+
+	measure(name, bytes, "rotate", n, [&]()
+	{
+		return timed([&]()
+		{
+			typename L::iterator it = l.begin();
+			std::advance(it, n / 2);
+			l.rotate(it);
+		});
+	});
+
+	measure(name, bytes, "sort", n, [&]()
+	{
+		L s = build<L>(n);
+		s.reverse();
+		return timed([&]() { s.sort(); });
+	});
+}
+
+template<class V>
+static void bench_payload(std::size_t n)
+{
+	// keep the biggest cases within a few hundred MB
+	if(n * (sizeof(V) + 2 * sizeof(void*)) > (std::size_t(1) << 29)) return;
+
+	bench_common<slist<V>, true>("slist", n);
+	bench_relink<slist<V>>("slist", n);
+	bench_common<slist<V, std::allocator<V>>, true>("slist_std_alloc", n);
+	bench_relink<slist<V, std::allocator<V>>>("slist_std_alloc", n);
+	bench_common<dslist<V>, true>("dslist", n);
+	bench_relink<dslist<V>>("dslist", n);
+	bench_common<uslist<V>, false>("uslist", n);
+}
+
+int main(int argc, char* argv[])
+{
+	std::size_t max_n = 1000000;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(std::strcmp(argv[i], "--json") == 0) json = true;
+		else max_n = std::strtoul(argv[i], nullptr, 10);
+	}
+	if(max_n > 10000000) max_n = 10000000;
+
+	if(!json) std::cout << "container,payload,op,n,reps,ns_per_op,ns_per_elem\n";
+	for(std::size_t n = 1000; n <= max_n; n *= 10)
+	{
+		bench_payload<unsigned>(n);
+		bench_payload<payload<32>>(n);
+		bench_payload<payload<128>>(n);
+	}
+
+	return 0;
+}
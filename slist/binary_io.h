@@ -0,0 +1,240 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <type_traits>
+
+// Building blocks of the binary container snapshots (slist_io.h, btree_io.h).
+//
+// A snapshot is a fixed header followed by the container's payload. All
+// fields are written in the machine's own byte order and width; the header
+// records enough (byte order mark, element size) for a reader on another
+// machine to refuse the file instead of misreading it.
+//
+//   offset  size  field
+//   0       4     magic, names the container ("SLST", "BTRE")
+//   4       2     version
+//   6       2     byte order mark, 0xFEFF as written
+//   8       4     sizeof(T) when keys are stored raw, else 0
+//   12      4     container specific flags
+//   16      8     element count
+//   24            payload
+
+constexpr std::uint16_t binary_byte_order = 0xFEFF;
+
+struct binary_header
+{
+	char magic[4];
+	std::uint16_t version;
+	std::uint16_t byte_order;
+	std::uint32_t elem_size;
+	std::uint32_t flags;
+	std::uint64_t count;
+};
+
+static_assert(sizeof(binary_header) == 24, "binary_header must have no padding");
+
+// Buffers small writes and hands the stream one large block at a time.
+class binary_writer
+{
+public:
+	explicit binary_writer(std::ostream& _os):
+		os(_os), used(0) {}
+
+	~binary_writer() { flush(); }
+
+	binary_writer(const binary_writer&) = delete;
+	binary_writer& operator=(const binary_writer&) = delete;
+
+	void write(const void* src, std::size_t n)
+	{
+		if(used + n > sizeof(buffer))
+		{
+			flush();
+			// big blocks skip the buffer
+			if(n >= sizeof(buffer))
+			{
+				os.write(static_cast<const char*>(src), n);
+				return;
+			}
+		}
+		std::memcpy(buffer + used, src, n);
+		used += n;
+	}
+
+	template<class U>
+	void put(const U& v)
+	{
+		static_assert(std::is_trivially_copyable<U>::value, "put writes raw bytes");
+		write(&v, sizeof(U));
+	}
+
+	void flush()
+	{
+		if(used == 0) return;
+		os.write(buffer, used);
+		used = 0;
+	}
+
+	bool good() const { return os.good(); }
+
+private:
+	std::ostream& os;
+	std::size_t used;
+	char buffer[1 << 16];
+};
+
+// Reads out of a byte range, usually a mapped file. Reads past the end fail
+// and leave ok() false rather than touching memory outside the range.
+class binary_reader
+{
+public:
+	binary_reader(const char* first, const char* last):
+		cur(first), end(last), good(true) {}
+
+	bool read(void* dst, std::size_t n)
+	{
+		if(!good || std::size_t(end - cur) < n) return good = false;
+		std::memcpy(dst, cur, n);
+		cur += n;
+		return true;
+	}
+
+	template<class U>
+	bool get(U& v)
+	{
+		static_assert(std::is_trivially_copyable<U>::value, "get reads raw bytes");
+		return read(&v, sizeof(U));
+	}
+
+	// a pointer to the next n bytes, consumed; nullptr if there are fewer
+	const char* take(std::size_t n)
+	{
+		if(!good || std::size_t(end - cur) < n)
+		{
+			good = false;
+			return nullptr;
+		}
+		const char* p = cur;
+		cur += n;
+		return p;
+	}
+
+	bool ok() const { return good; }
+	std::size_t remaining() const { return end - cur; }
+
+private:
+	const char* cur;
+	const char* end;
+	bool good;
+};
+
+// How one element is written and read. Trivially copyable types go out as
+// raw bytes, which lets the containers write whole runs of them at once;
+// other types need a specialization with raw = false, like std::string's.
+template<class T, class = void>
+struct binary_traits
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"specialize binary_traits for element types that are not trivially copyable");
+
+	static constexpr bool raw = true;
+
+	static void write(binary_writer& w, const T& v) { w.put(v); }
+	static bool read(binary_reader& r, T& v) { return r.get(v); }
+};
+
+template<>
+struct binary_traits<std::string>
+{
+	static constexpr bool raw = false;
+
+	static void write(binary_writer& w, const std::string& v)
+	{
+		w.put(std::uint64_t(v.size()));
+		w.write(v.data(), v.size());
+	}
+
+	static bool read(binary_reader& r, std::string& v)
+	{
+		std::uint64_t n;
+		if(!r.get(n) || n > r.remaining()) return false;
+		v.assign(r.take(n), n);
+		return true;
+	}
+};
+
+// Walks a block of raw elements, yielding each by value. The block is file
+// bytes with no alignment promise, so an element is copied out when read.
+// It is a forward iterator so that a container can count the block first
+// and take every node for it in one allocation.
+template<class T>
+class raw_element_iterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef T reference;
+
+	raw_element_iterator(const char* _p = nullptr):
+		p(_p) {}
+
+	inline bool operator==(const raw_element_iterator& rhs) const
+		{ return p == rhs.p; }
+	inline bool operator!=(const raw_element_iterator& rhs) const
+		{ return p != rhs.p; }
+
+	inline raw_element_iterator& operator++()
+	{
+		p += sizeof(T);
+		return *this;
+	}
+	inline raw_element_iterator operator++(int)
+	{
+		raw_element_iterator tmp(*this);
+		p += sizeof(T);
+		return tmp;
+	}
+
+	inline T operator*() const
+	{
+		alignas(T) unsigned char slot[sizeof(T)];
+		std::memcpy(slot, p, sizeof(T));
+		return *std::launder(reinterpret_cast<const T*>(slot));
+	}
+
+private:
+	const char* p;
+};
+
+// write_header(w, magic, version, elem_size, flags, count)	//Writes the common snapshot header.
+inline void write_header(binary_writer& w, const char* magic, std::uint16_t version,
+	std::uint32_t elem_size, std::uint32_t flags, std::uint64_t count)
+{
+	binary_header h;
+	std::memcpy(h.magic, magic, 4);
+	h.version = version;
+	h.byte_order = binary_byte_order;
+	h.elem_size = elem_size;
+	h.flags = flags;
+	h.count = count;
+	w.put(h);
+}
+
+// read_header(r, magic, version, elem_size, h)	//Reads a header; false unless it matches this build's layout.
+inline bool read_header(binary_reader& r, const char* magic, std::uint16_t version,
+	std::uint32_t elem_size, binary_header& h)
+{
+	return r.get(h) && std::memcmp(h.magic, magic, 4) == 0 && h.version == version
+		&& h.byte_order == binary_byte_order && h.elem_size == elem_size;
+}
+
+#endif
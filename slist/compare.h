@@ -0,0 +1,180 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+// Content equality, lexicographic ordering and hashing shared by slist,
+// uslist and btree. C++17 has no <=>, so ordering is a three-way compare
+// returning <0, 0 or >0, with the relational operators built on it.
+//
+// Elements compare with operator== and operator<. Types whose value is
+// exactly their bytes (integers, pointers, enums, structs of those with no
+// padding) compare with memcmp instead, a block at a time, wherever a
+// container keeps elements side by side: uslist nodes and btree leaves.
+//
+// Run sources walk a container as runs of adjacent elements. They hold
+//   p, e    the unvisited part of the current run
+//   next()  moves to the next run; false once there are none
+// and every run is non-empty.
+
+// true if two values are equal exactly when their bytes are
+template<class T>
+struct bitwise_equal: std::integral_constant<bool,
+	std::is_trivially_copyable<T>::value && std::has_unique_object_representations<T>::value> {};
+
+namespace compare_detail
+{
+	// elements per memcmp block: at least 64 bytes
+	template<class T>
+	constexpr std::size_t block()
+		{ return sizeof(T) >= 64 ? 1 : 64 / sizeof(T); }
+
+	inline std::uint64_t mix(std::uint64_t h, std::uint64_t v)
+	{
+		h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 32);
+	}
+}
+
+// mismatch_run(a, b, n)	//Returns the first index below n where a and b differ, or n.
+template<class T>
+std::size_t mismatch_run(const T* a, const T* b, std::size_t n)
+{
+	std::size_t i = 0;
+	if constexpr(bitwise_equal<T>::value)
+	{
+		// fixed-size memcmp compiles to a few wide loads and compares
+		const std::size_t k = compare_detail::block<T>();
+		for(; i + k <= n; i += k)
+			if(std::memcmp(a + i, b + i, k * sizeof(T)) != 0) break;
+	}
+	for(; i < n; ++i)
+		if(!(a[i] == b[i])) break;
+	return i;
+}
+
+// compare_values(a, b)		//Returns <0, 0 or >0 as a orders before, with or after b.
+template<class T>
+inline int compare_values(const T& a, const T& b)
+{
+	if(a < b) return -1;
+	if(b < a) return 1;
+	return 0;
+}
+
+// equal_runs(lhs, rhs)		//Returns true if two run sources hold the same elements.
+template<class L, class R>
+bool equal_runs(L lhs, R rhs)
+{
+	bool more_l = lhs.next();
+	bool more_r = rhs.next();
+	while(more_l && more_r)
+	{
+		std::size_t n = std::min<std::size_t>(lhs.e - lhs.p, rhs.e - rhs.p);
+		if(mismatch_run(lhs.p, rhs.p, n) != n) return false;
+		lhs.p += n;
+		rhs.p += n;
+		if(lhs.p == lhs.e) more_l = lhs.next();
+		if(rhs.p == rhs.e) more_r = rhs.next();
+	}
+	return more_l == more_r;
+}
+
+// compare_runs(lhs, rhs)	//Compares two run sources lexicographically.
+template<class L, class R>
+int compare_runs(L lhs, R rhs)
+{
+	bool more_l = lhs.next();
+	bool more_r = rhs.next();
+	while(more_l && more_r)
+	{
+		// skip the equal prefix, then order on the element that differs
+		std::size_t n = std::min<std::size_t>(lhs.e - lhs.p, rhs.e - rhs.p);
+		std::size_t i = mismatch_run(lhs.p, rhs.p, n);
+		if(i != n)
+		{
+			if(int c = compare_values(lhs.p[i], rhs.p[i])) return c;
+			++i;
+		}
+		lhs.p += i;
+		rhs.p += i;
+		if(lhs.p == lhs.e) more_l = lhs.next();
+		if(rhs.p == rhs.e) more_r = rhs.next();
+	}
+	return more_l ? 1 : more_r ? -1 : 0;
+}
+
+// compare_ranges(first1, last1, first2, last2)	//Compares two iterator ranges lexicographically.
+template<class It1, class It2>
+int compare_ranges(It1 first1, It1 last1, It2 first2, It2 last2)
+{
+	for(; first1 != last1 && first2 != last2; ++first1, ++first2)
+		if(int c = compare_values(*first1, *first2)) return c;
+	return first1 != last1 ? 1 : first2 != last2 ? -1 : 0;
+}
+
+// Hash of a sequence, fed one element or one run at a time. It depends
+// only on the elements and their order, never on how they were split into
+// runs, so equal containers hash alike whatever their node layout.
+template<class T>
+class sequence_hash
+{
+public:
+	sequence_hash():
+		h(0x243F6A8885A308D3ull), n(0) {}
+
+	void add(const T& v)
+	{
+		if constexpr(bitwise_equal<T>::value)
+		{
+			// the value's bytes, eight at a time, the last word zero padded
+			const unsigned char* b = reinterpret_cast<const unsigned char*>(&v);
+			std::size_t i = 0;
+			for(; i + 8 <= sizeof(T); i += 8)
+			{
+				std::uint64_t w;
+				std::memcpy(&w, b + i, 8);
+				h = compare_detail::mix(h, w);
+			}
+			if(i < sizeof(T))
+			{
+				std::uint64_t w = 0;
+				std::memcpy(&w, b + i, sizeof(T) - i);
+				h = compare_detail::mix(h, w);
+			}
+		}
+		else
+		{
+			h = compare_detail::mix(h, std::hash<T>()(v));
+		}
+		++n;
+	}
+
+	void add(const T* p, std::size_t k)
+	{
+		for(std::size_t i = 0; i < k; ++i) add(p[i]);
+	}
+
+	std::size_t value() const
+	{
+		// fold in the length, then finish with murmur3's 64-bit mixer
+		std::uint64_t x = compare_detail::mix(h, n);
+		x ^= x >> 33;
+		x *= 0xFF51AFD7ED558CCDull;
+		x ^= x >> 33;
+		x *= 0xC4CEB9FE1A85EC53ull;
+		x ^= x >> 33;
+		return std::size_t(x);
+	}
+
+private:
+	std::uint64_t h;
+	std::uint64_t n;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef CQUEUE_H
+#define CQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "hazard.h"
+
+// Lock-free multi-producer / multi-consumer FIFO (Michael & Scott).
+//
+// Shaped like slist: head always points at a sentinel node that holds no
+// value, the first element lives in head->next, and push links new nodes
+// in after tail. Popping an element turns its node into the new sentinel
+// and retires the old one. Unlinked nodes are reclaimed through hazard
+// pointers, so a node is never freed while another thread may still read
+// it.
+template<class T>
+class cqueue
+{
+	struct Node
+	{
+		Node():
+			next(nullptr) {}
+
+		inline T* value()
+			{ return std::launder(reinterpret_cast<T*>(storage)); }
+
+		std::atomic<Node*> next;
+		// constructed by push, destroyed by the pop that takes it
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	static void free_node(void* p)
+		{ delete static_cast<Node*>(p); }
+
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+
+	cqueue();
+	~cqueue();
+
+	cqueue(const cqueue&) = delete;
+	cqueue& operator=(const cqueue&) = delete;
+
+	// append element to end of queue
+	void push(const T&);
+	void push(T&&);
+	template<class... Args>
+	void emplace(Args&&...);
+
+	// move the front element into out; false if the queue was empty
+	bool try_pop(T& out);
+
+	// true if the queue held no elements at the moment of the call
+	bool empty() const;
+
+private:
+	void link(Node*);
+
+	// padded apart so producers and consumers do not share a cache line
+	alignas(64) std::atomic<Node*> head;
+	alignas(64) std::atomic<Node*> tail;
+};
+
+// Constructor
+template<class T>
+cqueue<T>::cqueue()
+{
+	Node* sent = new Node();
+	head.store(sent);
+	tail.store(sent);
+}
+
+// Destructor; no other thread may be using the queue
+template<class T>
+cqueue<T>::~cqueue()
+{
+	Node* n = head.load();
+	Node* next = n->next.load();
+	delete n;
+	while(next != nullptr)
+	{
+		n = next;
+		next = n->next.load();
+		n->value()->~T();
+		delete n;
+	}
+}
+
+// push(value)				//adds a new value to the end of this queue.
+template<class T>
+inline void cqueue<T>::push(const T& data)
+	{ emplace(data); }
+
+template<class T>
+inline void cqueue<T>::push(T&& data)
+	{ emplace(std::move(data)); }
+
+template<class T>
+template<class... Args>
+void cqueue<T>::emplace(Args&&... args)
+{
+	Node* n = new Node();
+	try
+	{
+		::new(static_cast<void*>(n->storage)) T(std::forward<Args>(args)...);
+	}
+	catch(...)
+	{
+		delete n;
+		throw;
+	}
+	link(n);
+}
+
+// link(node)				//swings tail->next to the node, then tail itself
+template<class T>
+void cqueue<T>::link(Node* n)
+{
+	hazard::owner& hp = hazard::local();
+
+	for(;;)
+	{
+		Node* t = hp.protect(tail, 0);
+		Node* next = t->next.load(std::memory_order_acquire);
+		if(t != tail.load()) continue;
+
+		if(next != nullptr)
+		{
+			// tail is lagging behind; help it along
+			tail.compare_exchange_weak(t, next);
+			continue;
+		}
+
+		Node* expected = nullptr;
+		if(t->next.compare_exchange_weak(expected, n, std::memory_order_release, std::memory_order_relaxed))
+		{
+			tail.compare_exchange_strong(t, n);
+			break;
+		}
+	}
+	hp.clear();
+}
+
+// try_pop(out)				//removes the front value of this queue into out.
+template<class T>
+bool cqueue<T>::try_pop(T& out)
+{
+	hazard::owner& hp = hazard::local();
+
+	for(;;)
+	{
+		Node* h = hp.protect(head, 0);
+		Node* t = tail.load();
+		Node* next = h->next.load(std::memory_order_acquire);
+		// next stays valid while h is still head: a node's next never changes once set
+		hp.set(1, next);
+		if(h != head.load()) continue;
+
+		if(next == nullptr)
+		{
+			hp.clear();
+			return false;
+		}
+
+		if(h == t)
+		{
+			tail.compare_exchange_weak(t, next);
+			continue;
+		}
+
+		if(head.compare_exchange_weak(h, next))
+		{
+			// next is now the sentinel; only this thread may take its value
+			out = std::move(*next->value());
+			next->value()->~T();
+			hp.clear();
+			hp.retire(h, &free_node);
+			return true;
+		}
+	}
+}
+
+// empty()					//Returns true if this queue contains no elements.
+template<class T>
+inline bool cqueue<T>::empty() const
+{
+	hazard::owner& hp = hazard::local();
+	Node* h = hp.protect(head, 0);
+	bool e = h->next.load(std::memory_order_acquire) == nullptr;
+	hp.clear();
+	return e;
+}
+
+#endif
@@ -28,7 +28,15 @@ int main()
 	slist<int>::iterator sub_lhs = sub.begin();
 	slist<int>::iterator sub_rhs = sub.end();
 
-	std::cout << sub;
+	std::cout << sub << std::endl;
+
+	// built separately from test, so only the contents can match
+	slist<int> rebuilt;
+	rebuilt.push_back(5);
+	rebuilt.push_back(7);
+	rebuilt.push_back(10);
+	std::cout << "separately built list " << (rebuilt.equals(test) ? "equals" : "differs from")
+		<< " the original" << std::endl;
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+// Text output for the containers' to_string, format_to and operator<<:
+// every element followed by one space, exactly as a default-formatted
+// std::ostream would print it. Numbers, characters and strings are
+// written straight into a char buffer with std::to_chars, with no stream,
+// locale or sentry involved; any other type falls back to its operator<<.
+
+// How one element is written. direct types supply
+//   bound(v)     chars write(p, v) may use, exact where that is cheap
+//   write(p, v)  writes v at p; returns the end
+// The primary template is the operator<< fallback.
+template<class T, class = void>
+struct element_format
+{
+	static constexpr bool direct = false;
+};
+
+namespace format_detail
+{
+	// decimal digits in v, 1 for 0
+	inline std::size_t digits(std::uint64_t v)
+	{
+		std::size_t n = 1;
+		for(; v >= 10000; v /= 10000) n += 4;
+		if(v >= 1000) return n + 3;
+		if(v >= 100) return n + 2;
+		if(v >= 10) return n + 1;
+		return n;
+	}
+
+	template<class T>
+	struct is_char: std::integral_constant<bool,
+		std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value> {};
+
+	// integers to_chars prints as numbers, the same as operator<< does
+	template<class T>
+	struct is_number: std::integral_constant<bool,
+		std::is_integral<T>::value && !std::is_same<T, bool>::value && !is_char<T>::value
+		&& !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value> {};
+}
+
+template<class T>
+struct element_format<T, typename std::enable_if<format_detail::is_number<T>::value>::type>
+{
+	static constexpr bool direct = true;
+
+	static std::size_t bound(T v)
+	{
+		typedef typename std::make_unsigned<T>::type U;
+		// negate in the unsigned type so the most negative value works too
+		return v < 0 ? 1 + format_detail::digits(U(0) - U(v)) : format_detail::digits(U(v));
+	}
+
+	static char* write(char* p, T v)
+		{ return std::to_chars(p, p + bound(v), v).ptr; }
+};
+
+template<class T>
+struct element_format<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static constexpr bool direct = true;
+
+	// sign, six digits, point and the longest exponent, "e-4951"
+	static std::size_t bound(T)
+		{ return 16; }
+
+	// %g with six significant digits: operator<<'s default
+	static char* write(char* p, T v)
+		{ return std::to_chars(p, p + 16, v, std::chars_format::general, 6).ptr; }
+};
+
+template<class T>
+struct element_format<T, typename std::enable_if<format_detail::is_char<T>::value>::type>
+{
+	static constexpr bool direct = true;
+
+	static std::size_t bound(T)
+		{ return 1; }
+
+	static char* write(char* p, T v)
+	{
+		*p = char(v);
+		return p + 1;
+	}
+};
+
+template<>
+struct element_format<bool>
+{
+	static constexpr bool direct = true;
+
+	static std::size_t bound(bool)
+		{ return 1; }
+
+	static char* write(char* p, bool v)
+	{
+		*p = v ? '1' : '0';
+		return p + 1;
+	}
+};
+
+template<>
+struct element_format<std::string>
+{
+	static constexpr bool direct = true;
+
+	static std::size_t bound(const std::string& v)
+		{ return v.size(); }
+
+	static char* write(char* p, const std::string& v)
+	{
+		std::memcpy(p, v.data(), v.size());
+		return p + v.size();
+	}
+};
+
+// format_chunks(first, last, sink)	//Formats [first, last), handing sink(data, n) one run of text at a time.
+template<class InputIt, class Sink>
+void format_chunks(InputIt first, InputIt last, Sink sink)
+{
+	typedef typename std::iterator_traits<InputIt>::value_type T;
+	typedef element_format<T> format;
+
+	if constexpr(format::direct)
+	{
+		char chunk[4096];
+		char* p = chunk;
+		for(; first != last; ++first)
+		{
+			std::size_t need = format::bound(*first) + 1;
+			if(need > std::size_t(chunk + sizeof(chunk) - p))
+			{
+				sink(static_cast<const char*>(chunk), std::size_t(p - chunk));
+				p = chunk;
+				// too long for the chunk at all: hand it over on its own
+				if(need > sizeof(chunk))
+				{
+					std::string big(need, '\0');
+					char* e = format::write(&big[0], *first);
+					*e++ = ' ';
+					sink(static_cast<const char*>(big.data()), std::size_t(e - big.data()));
+					continue;
+				}
+			}
+			p = format::write(p, *first);
+			*p++ = ' ';
+		}
+		sink(static_cast<const char*>(chunk), std::size_t(p - chunk));
+	}
+	else
+	{
+		std::ostringstream ss;
+		for(; first != last; ++first)
+		{
+			ss.str(std::string());
+			ss << *first << ' ';
+			const std::string& s = ss.str();
+			sink(s.data(), s.size());
+		}
+	}
+}
+
+// format_range(first, last, out)	//Writes each element and a space to an output iterator; returns its end.
+template<class InputIt, class OutputIt>
+OutputIt format_range(InputIt first, InputIt last, OutputIt out)
+{
+	format_chunks(first, last, [&out](const char* s, std::size_t n)
+		{ out = std::copy(s, s + n, out); });
+	return out;
+}
+
+// format_range(first, last, buf, n)	//Writes at most n chars to buf; returns the length the whole text needs.
+// Like snprintf, a return value above n means the text was cut short.
+// No terminating null is written.
+template<class InputIt>
+std::size_t format_range(InputIt first, InputIt last, char* buf, std::size_t n)
+{
+	std::size_t total = 0;
+	format_chunks(first, last, [&](const char* s, std::size_t k)
+	{
+		if(total < n) std::memcpy(buf + total, s, std::min(k, n - total));
+		total += k;
+	});
+	return total;
+}
+
+// format_string(first, last)	//Returns [first, last) as one string.
+// Forward ranges of direct types are measured first and written straight
+// into the string's own storage.
+template<class InputIt>
+std::string format_string(InputIt first, InputIt last)
+{
+	typedef typename std::iterator_traits<InputIt>::value_type T;
+	typedef element_format<T> format;
+	typedef typename std::iterator_traits<InputIt>::iterator_category category;
+
+	std::string out;
+	if constexpr(format::direct && std::is_base_of<std::forward_iterator_tag, category>::value)
+	{
+		std::size_t size = 0;
+		for(InputIt it = first; it != last; ++it)
+			size += format::bound(*it) + 1;
+		out.resize(size);
+
+		char* p = &out[0];
+		for(; first != last; ++first)
+		{
+			p = format::write(p, *first);
+			*p++ = ' ';
+		}
+		out.resize(p - out.data());
+	}
+	else
+	{
+		format_chunks(first, last, [&out](const char* s, std::size_t n)
+			{ out.append(s, n); });
+	}
+	return out;
+}
+
+// format_stream(os, first, last)	//Writes [first, last) to os without an intermediate string.
+template<class InputIt>
+std::ostream& format_stream(std::ostream& os, InputIt first, InputIt last)
+{
+	format_chunks(first, last, [&os](const char* s, std::size_t n)
+		{ os.write(s, n); });
+	return os;
+}
+
+#endif
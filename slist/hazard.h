@@ -0,0 +1,162 @@
+#ifndef HAZARD_H
+#define HAZARD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Hazard pointers for the lock-free containers.
+//
+// A thread publishes the nodes it is about to dereference in its record's
+// slots; a node that has been unlinked is retired instead of deleted and
+// only freed once a scan finds it in nobody's slots. Records are claimed
+// per thread on first use and handed back when the thread exits.
+namespace hazard
+{
+	constexpr std::size_t slots_per_thread = 2;
+
+	struct record
+	{
+		std::atomic<const void*> slot[slots_per_thread];
+		std::atomic<bool> active;
+		record* next;
+	};
+
+	struct retired
+	{
+		void* ptr;
+		void (*del)(void*);
+	};
+
+	// every record ever created; records are reused, never freed
+	inline std::atomic<record*> records{nullptr};
+	inline std::atomic<std::size_t> record_count{0};
+
+	// nodes left behind by exited threads that were still protected
+	inline std::mutex orphan_lock;
+	inline std::vector<retired> orphans;
+
+	class owner
+	{
+	public:
+		owner():
+			rec(acquire()) {}
+
+		~owner()
+		{
+			for(std::size_t i = 0; i < slots_per_thread; ++i)
+				rec->slot[i].store(nullptr);
+			scan();
+			if(!garbage.empty())
+			{
+				std::lock_guard<std::mutex> lock(orphan_lock);
+				orphans.insert(orphans.end(), garbage.begin(), garbage.end());
+			}
+			rec->active.store(false);
+		}
+
+		owner(const owner&) = delete;
+		owner& operator=(const owner&) = delete;
+
+		// publish *src in slot i and return it once it is known to be stable
+		template<class N>
+		N* protect(const std::atomic<N*>& src, std::size_t i)
+		{
+			N* p = src.load();
+			for(;;)
+			{
+				rec->slot[i].store(p);
+				N* q = src.load();
+				if(q == p) return p;
+				p = q;
+			}
+		}
+
+		// publish a pointer already validated by the caller
+		void set(std::size_t i, const void* p)
+			{ rec->slot[i].store(p); }
+
+		void clear()
+		{
+			for(std::size_t i = 0; i < slots_per_thread; ++i)
+				rec->slot[i].store(nullptr, std::memory_order_release);
+		}
+
+		// hand p over for deletion once no thread protects it
+		void retire(void* p, void (*del)(void*))
+		{
+			garbage.push_back(retired{p, del});
+			std::size_t threshold = 4 * slots_per_thread * record_count.load(std::memory_order_relaxed);
+			if(garbage.size() >= (threshold > 64 ? threshold : 64))
+				scan();
+		}
+
+		// free every retired pointer that no slot currently holds
+		void scan()
+		{
+			{
+				std::unique_lock<std::mutex> lock(orphan_lock, std::try_to_lock);
+				if(lock.owns_lock() && !orphans.empty())
+				{
+					garbage.insert(garbage.end(), orphans.begin(), orphans.end());
+					orphans.clear();
+				}
+			}
+
+			std::vector<const void*> live;
+			for(record* r = records.load(); r != nullptr; r = r->next)
+			{
+				for(std::size_t i = 0; i < slots_per_thread; ++i)
+				{
+					const void* p = r->slot[i].load();
+					if(p != nullptr) live.push_back(p);
+				}
+			}
+			std::sort(live.begin(), live.end());
+
+			std::size_t kept = 0;
+			for(std::size_t i = 0; i < garbage.size(); ++i)
+			{
+				if(std::binary_search(live.begin(), live.end(), static_cast<const void*>(garbage[i].ptr)))
+					garbage[kept++] = garbage[i];
+				else
+					garbage[i].del(garbage[i].ptr);
+			}
+			garbage.resize(kept);
+		}
+
+	private:
+		static record* acquire()
+		{
+			for(record* r = records.load(); r != nullptr; r = r->next)
+			{
+				bool idle = false;
+				if(r->active.compare_exchange_strong(idle, true))
+					return r;
+			}
+
+			record* r = new record();
+			for(std::size_t i = 0; i < slots_per_thread; ++i)
+				r->slot[i].store(nullptr);
+			r->active.store(true);
+			r->next = records.load();
+			while(!records.compare_exchange_weak(r->next, r)) {}
+			record_count.fetch_add(1);
+			return r;
+		}
+
+		record* rec;
+		std::vector<retired> garbage;
+	};
+
+	// the calling thread's hazard record
+	inline owner& local()
+	{
+		thread_local owner o;
+		return o;
+	}
+}
+
+#endif
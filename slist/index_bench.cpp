@@ -0,0 +1,130 @@
+// Nearest-airport and radius queries: airport_index against a linear scan.
+//
+// usage: index_bench [queries] [csv]
+//
+// Queries are centred on airports picked at random from the file, nudged
+// by up to half a degree so they rarely sit exactly on one. Each query
+// runs through the index and through a full distanceEarth scan, and the
+// two answers must agree. Output is CSV: query,param,queries,scan_us,index_us,speedup
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "airport.h"
+#include "airport_index.h"
+
+struct probe
+{
+	double lat;
+	double lon;
+};
+
+static std::vector<airport_hit> scan_nearest(const std::vector<Airport>& airports, const probe& q, std::size_t k)
+{
+	std::vector<airport_hit> all;
+	all.reserve(airports.size());
+	for(std::size_t i = 0; i < airports.size(); ++i)
+		all.push_back(airport_hit{distanceEarth(q.lat, q.lon, airports[i].latitude, airports[i].longitude), i});
+	if(k > all.size()) k = all.size();
+	std::partial_sort(all.begin(), all.begin() + k, all.end());
+	all.resize(k);
+	return all;
+}
+
+static std::vector<airport_hit> scan_within(const std::vector<Airport>& airports, const probe& q, double km)
+{
+	std::vector<airport_hit> out;
+	for(std::size_t i = 0; i < airports.size(); ++i)
+	{
+		double d = distanceEarth(q.lat, q.lon, airports[i].latitude, airports[i].longitude);
+		if(d <= km) out.push_back(airport_hit{d, i});
+	}
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+static bool same(const std::vector<airport_hit>& lhs, const std::vector<airport_hit>& rhs)
+{
+	if(lhs.size() != rhs.size()) return false;
+	for(std::size_t i = 0; i < lhs.size(); ++i)
+		if(lhs[i].index != rhs[i].index || lhs[i].km != rhs[i].km) return false;
+	return true;
+}
+
+// times query(q) over every probe; returns total microseconds, results in out
+template<class Query>
+static double run(const std::vector<probe>& probes, std::vector<std::vector<airport_hit>>& out, Query query)
+{
+	out.clear();
+	out.reserve(probes.size());
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(const probe& q: probes)
+		out.push_back(query(q));
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool report(const char* query, double param, std::size_t n, double scan, double index,
+	const std::vector<std::vector<airport_hit>>& expect, const std::vector<std::vector<airport_hit>>& got)
+{
+	bool ok = true;
+	for(std::size_t i = 0; ok && i < expect.size(); ++i)
+		ok = same(expect[i], got[i]);
+
+	std::cout << query << ',' << param << ',' << n << ',' << scan << ',' << index << ','
+		<< (scan / index) << (ok ? "" : ",MISMATCH") << std::endl;
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	std::size_t queries = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200;
+	const char* path = (argc > 2) ? argv[2] : "./USAirportCodes.csv";
+
+	std::vector<Airport> airports;
+	if(!load_airports(path, airports) || airports.empty())
+	{
+		std::cout << "Error opening file" << std::endl;
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	airport_index index(airports);
+	std::chrono::duration<double, std::milli> built = std::chrono::steady_clock::now() - start;
+	std::cerr << "indexed " << index.size() << " airports in " << built.count() << " ms" << std::endl;
+
+	std::mt19937 rng(12345);
+	std::uniform_int_distribution<std::size_t> pick(0, airports.size() - 1);
+	std::uniform_real_distribution<double> nudge(-0.5, 0.5);
+	std::vector<probe> probes;
+	for(std::size_t i = 0; i < queries; ++i)
+	{
+		const Airport& a = airports[pick(rng)];
+		probes.push_back(probe{a.latitude + nudge(rng), a.longitude + nudge(rng)});
+	}
+
+	bool ok = true;
+	std::vector<std::vector<airport_hit>> expect, got;
+	std::cout << "query,param,queries,scan_us,index_us,speedup" << std::endl;
+
+	const std::size_t ks[] = { 1, 10, 100 };
+	for(std::size_t k: ks)
+	{
+		double scan = run(probes, expect, [&](const probe& q) { return scan_nearest(airports, q, k); });
+		double fast = run(probes, got, [&](const probe& q) { return index.nearest(q.lat, q.lon, k); });
+		ok = report("nearest", k, queries, scan, fast, expect, got) && ok;
+	}
+
+	const double radii[] = { 25, 100, 500 };
+	for(double km: radii)
+	{
+		double scan = run(probes, expect, [&](const probe& q) { return scan_within(airports, q, km); });
+		double fast = run(probes, got, [&](const probe& q) { return index.within(q.lat, q.lon, km); });
+		ok = report("within", km, queries, scan, fast, expect, got) && ok;
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,533 @@
+#ifndef INDEXED_SLIST_H
+#define INDEXED_SLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "slist.h"
+
+// slist with positional access in O(log n): an indexable skip list laid
+// over the list's own nodes.
+//
+// The list is the bottom level. About one element in four also carries a
+// tower, and each tower level reaches up one more with probability 1/4.
+// A tower level links to the next tower of at least that height and
+// records how many positions it spans. Finding position k goes down from
+// the top level, adding spans while they stay within k, then walks the
+// few remaining links, about four, in the list itself. Inserts and erases
+// go through the same descent and fix the spans they cross, so both are
+// O(log n) as well, and so are pop_back and push_back.
+//
+// Positions are slist iterator positions: position k is the iterator
+// whose element is at index k, so position 0 is begin() and position
+// size() is end(). A tower sits at the iterator just past its element,
+// which names the element's own node and therefore stays put while others
+// come and go. The sentinel carries the head tower, at position 0.
+//
+// All changes go through this class so the index cannot fall out of date;
+// list() gives read-only access to the slist for everything else.
+template<class T, class Alloc = node_pool<T>>
+class indexed_slist
+{
+public:
+	typedef slist<T, Alloc> list_type;
+	typedef T value_type;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef typename list_type::const_iterator const_iterator;
+	typedef typename list_type::view view;
+
+	// tower levels; enough for 4^16 elements
+	static constexpr size_type max_level = 16;
+
+private:
+	typedef typename list_type::iterator iterator;
+
+	struct Tower;
+
+	// one level of a tower: the next tower this high, and the positions to it
+	struct Level
+	{
+		Tower* next;
+		size_type span;
+	};
+
+	// levels live in the same allocation, right after the tower
+	struct Tower
+	{
+		iterator pos;
+		size_type height;
+		Level* lv;
+	};
+
+	list_type items;
+	Tower head;
+	Level head_levels[max_level];
+	// levels in use by some tower
+	size_type levels;
+	// xorshift state for tower heights
+	std::uint64_t seed;
+
+	static Tower* make_tower(const iterator& pos, size_type height);
+	static void free_tower(Tower*);
+
+	size_type random_height();
+
+	// for every level in use, the last tower at or before position k and its
+	// position; returns the lowest of them, at[0]
+	Tower* trace(size_type k, Tower** update, size_type* at);
+	// iterator at position k
+	iterator locate(size_type k) const;
+
+	// free every tower and index items afresh in one pass
+	void build();
+	void drop_towers();
+
+	template<class... Args>
+	void insert_at(size_type k, Args&&... args);
+
+public:
+	indexed_slist();
+	// take over a list's nodes and index them in O(n)
+	explicit indexed_slist(list_type&& list);
+	indexed_slist(const indexed_slist& other);
+	indexed_slist(indexed_slist&& other) noexcept;
+
+	indexed_slist& operator=(const indexed_slist& other);
+	indexed_slist& operator=(indexed_slist&& other);
+
+	// return true if empty
+	bool empty() const;
+
+	// return size of list
+	size_type size() const;
+
+	// clear list
+	void clear();
+
+	// the underlying list, for reading
+	const list_type& list() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	// iterator at position k, 0 to size()
+	const_iterator iterator_at(size_type k) const;
+
+	// element at index k; at() throws std::out_of_range past the end
+	const_reference operator[](size_type k) const;
+	const_reference at(size_type k) const;
+
+	// replace the element at index k
+	void set(size_type k, const T&);
+	void set(size_type k, T&&);
+
+	// up to count elements from index k, without copying
+	view slice(size_type k, size_type count) const;
+
+	// insert at index k, 0 to size(), moving later elements up one
+	void insert(size_type k, const T&);
+	void insert(size_type k, T&&);
+	template<class... Args>
+	void emplace(size_type k, Args&&...);
+
+	// erase the element at index k
+	void erase(size_type k);
+
+	void push_back(const T&);
+	void push_back(T&&);
+	void push_front(const T&);
+	void push_front(T&&);
+	void pop_back();
+	void pop_front();
+
+	// destroy
+	~indexed_slist();
+};
+
+// Constructor
+template<class T, class Alloc>
+indexed_slist<T, Alloc>::indexed_slist():
+	items(), head{items.begin(), max_level, head_levels}, levels(0), seed(0x9E3779B97F4A7C15ull) {}
+
+template<class T, class Alloc>
+indexed_slist<T, Alloc>::indexed_slist(list_type&& list):
+	items(std::move(list)), head{items.begin(), max_level, head_levels}, levels(0), seed(0x9E3779B97F4A7C15ull)
+{
+	build();
+}
+
+template<class T, class Alloc>
+indexed_slist<T, Alloc>::indexed_slist(const indexed_slist& other):
+	indexed_slist(list_type(other.items)) {}
+
+// the nodes change hands, so the towers do too; only the head tower is
+// anchored on the sentinel, which stays with its list object
+template<class T, class Alloc>
+indexed_slist<T, Alloc>::indexed_slist(indexed_slist&& other) noexcept:
+	items(std::move(other.items)), head{items.begin(), max_level, head_levels}, levels(other.levels), seed(other.seed)
+{
+	for(size_type l = 0; l < levels; ++l) head_levels[l] = other.head_levels[l];
+	other.levels = 0;
+}
+
+template<class T, class Alloc>
+indexed_slist<T, Alloc>& indexed_slist<T, Alloc>::operator=(const indexed_slist& other)
+{
+	if(this != &other) *this = indexed_slist(other);
+	return *this;
+}
+
+template<class T, class Alloc>
+indexed_slist<T, Alloc>& indexed_slist<T, Alloc>::operator=(indexed_slist&& other)
+{
+	if(this == &other) return *this;
+
+	drop_towers();
+	// a list that cannot take other's storage moves the elements into new
+	// nodes, and other's towers name the old ones
+	const T* front = other.empty() ? nullptr : &*other.items.cbegin();
+	items = std::move(other.items);
+	head.pos = items.begin();
+
+	if(!items.empty() && &*items.cbegin() != front)
+	{
+		other.drop_towers();
+		build();
+		return *this;
+	}
+
+	levels = other.levels;
+	for(size_type l = 0; l < levels; ++l) head_levels[l] = other.head_levels[l];
+	other.levels = 0;
+	return *this;
+}
+
+// Destructor
+template<class T, class Alloc>
+inline indexed_slist<T, Alloc>::~indexed_slist()
+	{ drop_towers(); }
+
+// make_tower(pos, height)	//Allocates a tower and its levels in one block.
+template<class T, class Alloc>
+typename indexed_slist<T, Alloc>::Tower* indexed_slist<T, Alloc>::make_tower(const iterator& pos, size_type height)
+{
+	static_assert(sizeof(Tower) % alignof(Level) == 0, "levels follow the tower directly");
+	void* raw = ::operator new(sizeof(Tower) + height * sizeof(Level));
+	Level* lv = reinterpret_cast<Level*>(static_cast<char*>(raw) + sizeof(Tower));
+	for(size_type l = 0; l < height; ++l) ::new(static_cast<void*>(lv + l)) Level{nullptr, 0};
+	return ::new(raw) Tower{pos, height, lv};
+}
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::free_tower(Tower* t)
+{
+	t->~Tower();
+	::operator delete(static_cast<void*>(t));
+}
+
+// random_height()			//Returns 0 three times in four, and each level above with odds 1/4.
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::size_type indexed_slist<T, Alloc>::random_height()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+
+	size_type h = 0;
+	for(std::uint64_t r = seed; (r & 3) == 0 && h < max_level; r >>= 2) ++h;
+	return h;
+}
+
+// drop_towers()			//Frees every tower but the head's.
+template<class T, class Alloc>
+void indexed_slist<T, Alloc>::drop_towers()
+{
+	if(levels > 0)
+	{
+		// every tower is on level 0
+		for(Tower* t = head_levels[0].next; t != nullptr; )
+		{
+			Tower* next = t->lv[0].next;
+			free_tower(t);
+			t = next;
+		}
+	}
+	levels = 0;
+}
+
+// build()					//Indexes every element of items in one pass.
+template<class T, class Alloc>
+void indexed_slist<T, Alloc>::build()
+{
+	drop_towers();
+	head.pos = items.begin();
+
+	// the last tower on each level so far and its position
+	Tower* last[max_level];
+	size_type at[max_level];
+	for(size_type l = 0; l < max_level; ++l)
+	{
+		head_levels[l] = Level{nullptr, 0};
+		last[l] = &head;
+		at[l] = 0;
+	}
+
+	size_type k = 0;
+	for(iterator it = items.begin(); it != items.end(); )
+	{
+		++it;
+		++k;
+		size_type h = random_height();
+		if(h == 0) continue;
+
+		Tower* t = make_tower(it, h);
+		for(size_type l = 0; l < h; ++l)
+		{
+			last[l]->lv[l] = Level{t, k - at[l]};
+			last[l] = t;
+			at[l] = k;
+		}
+		if(h > levels) levels = h;
+	}
+}
+
+// trace(k, update, at)		//Descends to position k, noting where it leaves each level.
+template<class T, class Alloc>
+typename indexed_slist<T, Alloc>::Tower* indexed_slist<T, Alloc>::trace(size_type k, Tower** update, size_type* at)
+{
+	Tower* x = &head;
+	size_type p = 0;
+	for(size_type l = levels; l-- > 0; )
+	{
+		while(x->lv[l].next != nullptr && p + x->lv[l].span <= k)
+		{
+			p += x->lv[l].span;
+			x = x->lv[l].next;
+		}
+		update[l] = x;
+		at[l] = p;
+	}
+	if(levels == 0) at[0] = 0;
+	return x;
+}
+
+// locate(k)				//Returns the iterator at position k.
+template<class T, class Alloc>
+typename indexed_slist<T, Alloc>::iterator indexed_slist<T, Alloc>::locate(size_type k) const
+{
+	const Tower* x = &head;
+	size_type p = 0;
+	for(size_type l = levels; l-- > 0; )
+		while(x->lv[l].next != nullptr && p + x->lv[l].span <= k)
+		{
+			p += x->lv[l].span;
+			x = x->lv[l].next;
+		}
+
+	iterator it = x->pos;
+	for(; p < k; ++p) ++it;
+	return it;
+}
+
+template<class T, class Alloc>
+template<class... Args>
+void indexed_slist<T, Alloc>::insert_at(size_type k, Args&&... args)
+{
+	Tower* update[max_level];
+	size_type at[max_level];
+	Tower* x = trace(k, update, at);
+
+	iterator pos = x->pos;
+	for(size_type p = at[0]; p < k; ++p) ++pos;
+	// emplace returns the insert position; one step on is the new node
+	iterator made = items.emplace(pos, std::forward<Args>(args)...);
+	++made;
+
+	size_type h = random_height();
+	Tower* t = nullptr;
+	if(h > 0)
+	{
+		try
+		{
+			t = make_tower(made, h);
+		}
+		catch(...)
+		{
+			// without its tower the element is still correctly indexed
+			h = 0;
+		}
+	}
+	for(; levels < h; ++levels)
+	{
+		head_levels[levels] = Level{nullptr, 0};
+		update[levels] = &head;
+		at[levels] = 0;
+	}
+
+	// the new element is at position k + 1; spans across it grow by one
+	for(size_type l = 0; l < levels; ++l)
+	{
+		Level& u = update[l]->lv[l];
+		if(l < h)
+		{
+			t->lv[l] = Level{u.next, u.next != nullptr ? at[l] + u.span - k : 0};
+			u.next = t;
+			u.span = k + 1 - at[l];
+		}
+		else if(u.next != nullptr)
+		{
+			++u.span;
+		}
+	}
+}
+
+//empty()					//Returns true if this list is empty.
+template<class T, class Alloc>
+inline bool indexed_slist<T, Alloc>::empty() const
+	{ return items.empty(); }
+
+//size()					//Returns the number of elements in this list.
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::size_type indexed_slist<T, Alloc>::size() const
+	{ return items.size(); }
+
+// clear()					//erases all elements from this list.
+template<class T, class Alloc>
+void indexed_slist<T, Alloc>::clear()
+{
+	drop_towers();
+	items.clear();
+	head.pos = items.begin();
+}
+
+template<class T, class Alloc>
+inline const typename indexed_slist<T, Alloc>::list_type& indexed_slist<T, Alloc>::list() const
+	{ return items; }
+
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::const_iterator indexed_slist<T, Alloc>::begin() const
+	{ return items.cbegin(); }
+
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::const_iterator indexed_slist<T, Alloc>::end() const
+	{ return items.cend(); }
+
+// iterator_at(k)			//Returns the iterator at position k in O(log n).
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::const_iterator indexed_slist<T, Alloc>::iterator_at(size_type k) const
+	{ return locate(k); }
+
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::const_reference indexed_slist<T, Alloc>::operator[](size_type k) const
+	{ return *locate(k); }
+
+template<class T, class Alloc>
+inline typename indexed_slist<T, Alloc>::const_reference indexed_slist<T, Alloc>::at(size_type k) const
+{
+	if(k >= size()) throw std::out_of_range("indexed_slist::at");
+	return *locate(k);
+}
+
+// set(index, value)		//Replaces the element at the specified index in this list with a new value.
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::set(size_type k, const T& data)
+	{ *locate(k) = data; }
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::set(size_type k, T&& data)
+	{ *locate(k) = std::move(data); }
+
+// slice(index, count)		//Returns a view of up to count elements from index.
+template<class T, class Alloc>
+typename indexed_slist<T, Alloc>::view indexed_slist<T, Alloc>::slice(size_type k, size_type count) const
+{
+	if(k > size()) k = size();
+	if(count > size() - k) count = size() - k;
+	const_iterator first = locate(k);
+	// short slices walk on from the start; long ones look the end up too
+	if(count <= 4 * max_level) return items.get(first, count);
+	return view(first, locate(k + count));
+}
+
+// insert(index, value)		//Inserts value so that it ends up at index.
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::insert(size_type k, const T& data)
+	{ insert_at(k, data); }
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::insert(size_type k, T&& data)
+	{ insert_at(k, std::move(data)); }
+
+template<class T, class Alloc>
+template<class... Args>
+inline void indexed_slist<T, Alloc>::emplace(size_type k, Args&&... args)
+	{ insert_at(k, std::forward<Args>(args)...); }
+
+// erase(index)				//Removes the element at index.
+template<class T, class Alloc>
+void indexed_slist<T, Alloc>::erase(size_type k)
+{
+	Tower* update[max_level];
+	size_type at[max_level];
+	Tower* x = trace(k, update, at);
+
+	// the element's own tower, if it has one, is the next one at position k + 1
+	Tower* victim = nullptr;
+	if(levels > 0 && x->lv[0].next != nullptr && at[0] + x->lv[0].span == k + 1)
+		victim = x->lv[0].next;
+
+	for(size_type l = 0; l < levels; ++l)
+	{
+		Level& u = update[l]->lv[l];
+		if(victim != nullptr && u.next == victim)
+		{
+			const Level& v = victim->lv[l];
+			u.span = v.next != nullptr ? u.span + v.span - 1 : 0;
+			u.next = v.next;
+		}
+		else if(u.next != nullptr)
+		{
+			--u.span;
+		}
+	}
+
+	iterator pos = x->pos;
+	for(size_type p = at[0]; p < k; ++p) ++pos;
+	items.erase(pos);
+
+	if(victim != nullptr) free_tower(victim);
+	while(levels > 0 && head_levels[levels - 1].next == nullptr) --levels;
+}
+
+// push_back(value)			//adds a new value to the end of this list.
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::push_back(const T& data)
+	{ insert_at(size(), data); }
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::push_back(T&& data)
+	{ insert_at(size(), std::move(data)); }
+
+// push_front(value)		//adds a new value to the front of this list.
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::push_front(const T& data)
+	{ insert_at(0, data); }
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::push_front(T&& data)
+	{ insert_at(0, std::move(data)); }
+
+// pop_back()				//Removes the last element in O(log n), where slist walks the list.
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::pop_back()
+	{ erase(size() - 1); }
+
+template<class T, class Alloc>
+inline void indexed_slist<T, Alloc>::pop_front()
+	{ erase(0); }
+
+#endif
@@ -6,70 +6,70 @@
 //  Copyright © 2016 James Shockey. All rights reserved.
 //
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <cmath>
-#include <cstdlib>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include <vector>
 #include "slist.h"
+#include "airport.h"
+#include "airport_store.h"
 
-struct Airport
-{
-	char code[5];
-	double longitude;
-	double latitude;
-};
-
+// sorts s[0..c) by distance from Austin Bergstrom (AUS), nearest first
 void simpleSortTotal(Airport* s[], int c);
 
-double distanceEarth(double lat1d, double lon1d, double lat2d, double lon2d);
-
 int main()
 {
-	std::ifstream infile;
-	int i=0;
-	char cNum[10] ;
-	Airport* airportArr[13500];
-	int airportCount;
-	//Airport* a[13500];
-
-	infile.open ("./USAirportCodes.csv", std::ifstream::in);
-	if (infile.is_open())
+	std::vector<Airport> airports;
+	double loadMs;
+
+	if (load_airports("./USAirportCodes.csv", airports, &loadMs))
 	{
-		int   c=0;
-		while (infile.good())
-		{
-			airportArr[c] = new Airport();
-			infile.getline(airportArr[c]->code, 256, ',');
-			infile.getline(cNum, 256, ',');
-			airportArr[c]->longitude = std::atof(cNum);
-			infile.getline(cNum, 256, '\n');
-			airportArr[c]->latitude = std::atof(cNum);
+		int airportCount = airports.size();
+		std::vector<Airport*> airportPtrs(airportCount);
+		Airport** airportArr = airportPtrs.data();
+		for (int c=0; c < airportCount; c++)
+			airportArr[c] = &airports[c];
 
-			if (!(c % 1000))
-				std::cout << airportArr[c]->code << " long: " << airportArr[c]->longitude << " lat: " << airportArr[c]->latitude <<  std::endl;
+		std::cout << "Loaded " << airportCount << " airports in " << loadMs << " ms" << std::endl;
 
-			/*
-			if (!(c % 1000))
-			{
-				cout << airportArr[c]->code << " long: " << airportArr[c]->longitude << " lat: " << airportArr[c]->latitude <<  endl;
-				cout << airportArr[c+1]->code << endl; //" long: " << airportArr[c+1]->longitude << " lat: " << airportArr[c+1]->latitude <<  endl;                               
-			}
-			*/
-
-			i++ ;
-			c++;
-		}
-		airportCount = c-1;
-		infile.close();
-		
 		 for (int c=0; c < airportCount; c++)
 			if (!(c % 1000))
 			{
 				std::cout << airportArr[c]->code << " long: " << airportArr[c]->longitude << " lat: " << airportArr[c]->latitude <<  std::endl;
 				std::cout << airportArr[c+1]->code << " long: " << airportArr[c+1]->longitude << " lat: " << airportArr[c+1]->latitude <<  std::endl;
 				std::cout <<"Distance between " << airportArr[c]->code << " and " << airportArr[c+1]->code << " is "
-				  << distanceEarth( airportArr[c]->longitude, airportArr[c]->latitude , airportArr[c+1]->longitude, airportArr[c+1]->latitude) << std::endl;
+				  << distanceEarth( airportArr[c]->latitude, airportArr[c]->longitude , airportArr[c+1]->latitude, airportArr[c+1]->longitude) << std::endl;
+			}
+
+		// one-to-all distances from AUS through the columnar store
+		airport_store store(airports.begin(), airports.end());
+		std::vector<double> fromAus(airportCount);
+		for (int c=0; c < airportCount; c++)
+			if (std::strcmp(store.code(c), "AUS") == 0)
+			{
+				std::chrono::steady_clock::time_point sweepStart = std::chrono::steady_clock::now();
+				store.distances_from(c, fromAus.data());
+				std::chrono::duration<double, std::micro> sweepTime = std::chrono::steady_clock::now() - sweepStart;
+
+				double maxErr = 0;
+				for (int k=0; k < airportCount; k++)
+					maxErr = std::max(maxErr, std::abs(fromAus[k] - distanceEarth(airports[c].latitude, airports[c].longitude, airports[k].latitude, airports[k].longitude)));
+				std::cout << "Distances from AUS to " << airportCount << " airports in " << sweepTime.count()
+					<< " us (max error " << maxErr * 1000 << " m)" << std::endl;
+				break;
 			}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		simpleSortTotal(airportArr, airportCount);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "Sorted " << airportCount << " airports by distance from AUS in " << elapsed.count() << " ms" << std::endl;
+		for (int c=0; c < airportCount && c < 5; c++)
+			std::cout << "  " << airportArr[c]->code << std::endl;
+		std::cout << "Farthest: " << airportArr[airportCount-1]->code << std::endl;
 	}
 	else
 	{
@@ -87,45 +87,24 @@ int main()
 
 
 
-#define pi 3.14159265358979323846
-#define earthRadiusKm 6371.0
-
-// This function converts decimal degrees to radians
-double deg2rad(double deg) {
-  return (deg * pi / 180);
-}
-
-//  This function converts radians to decimal degrees
-double rad2deg(double rad) {
-  return (rad * 180 / pi);
-}
-
-
-/**
- * Returns the distance between two points on the Earth.
- * Direct translation from http://en.wikipedia.org/wiki/Haversine_formula
- * @param lat1d Latitude of the first point in degrees
- * @param lon1d Longitude of the first point in degrees
- * @param lat2d Latitude of the second point in degrees
- * @param lon2d Longitude of the second point in degrees
- * @return The distance between the two points in kilometers
- */
-double distanceEarth(double lat1d, double lon1d, double lat2d, double lon2d) {
-  double lat1r, lon1r, lat2r, lon2r, u, v;
-  lat1r = deg2rad(lat1d);
-  lon1r = deg2rad(lon1d);
-  lat2r = deg2rad(lat2d);
-  lon2r = deg2rad(lon2d);
-  u = sin((lat2r - lat1r)/2);
-  v = sin((lon2r - lon1r)/2);
-  return 2.0 * earthRadiusKm * asin(sqrt(u * u + cos(lat1r) * cos(lat2r) * v * v));
-}
-
-
-
-/*
-void simpleSortTotal()
+void simpleSortTotal(Airport* s[], int c)
 {
-
+	const Airport* origin = nullptr;
+	for (int i = 0; i < c && origin == nullptr; i++)
+		if (std::strcmp(s[i]->code, "AUS") == 0)
+			origin = s[i];
+	if (origin == nullptr)
+		return;
+
+	// key each airport once so the sort compares doubles, not haversines
+	slist<std::pair<double, Airport*>> ranked;
+	for (int i = 0; i < c; i++)
+		ranked.emplace_back(distanceEarth(origin->latitude, origin->longitude, s[i]->latitude, s[i]->longitude), s[i]);
+
+	ranked.sort([](const std::pair<double, Airport*>& lhs, const std::pair<double, Airport*>& rhs)
+		{ return lhs.first < rhs.first; });
+
+	int i = 0;
+	for (slist<std::pair<double, Airport*>>::iterator it = ranked.begin(); it != ranked.end(); ++it)
+		s[i++] = it->second;
 }
-*/
@@ -0,0 +1,74 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. On POSIX systems the file is mapped, not
+// read, so parsing works straight out of the page cache.
+class mapped_file
+{
+public:
+	explicit mapped_file(const char* path):
+		ptr(nullptr), len(0)
+	{
+#if defined(_WIN32)
+		std::ifstream in(path, std::ios::binary);
+		if(!in) return;
+		std::ostringstream ss;
+		ss << in.rdbuf();
+		buffer = ss.str();
+		ptr = buffer.data();
+		len = buffer.size();
+#else
+		int fd = ::open(path, O_RDONLY);
+		if(fd < 0) return;
+		struct stat st;
+		if(::fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			void* m = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(m != MAP_FAILED)
+			{
+				::madvise(m, st.st_size, MADV_SEQUENTIAL);
+				ptr = static_cast<const char*>(m);
+				len = st.st_size;
+			}
+		}
+		::close(fd);
+#endif
+	}
+
+	~mapped_file()
+	{
+#if !defined(_WIN32)
+		if(ptr != nullptr) ::munmap(const_cast<char*>(ptr), len);
+#endif
+	}
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	bool is_open() const { return ptr != nullptr; }
+	const char* begin() const { return ptr; }
+	const char* end() const { return ptr + len; }
+	std::size_t size() const { return len; }
+
+private:
+	const char* ptr;
+	std::size_t len;
+#if defined(_WIN32)
+	std::string buffer;
+#endif
+};
+
+#endif
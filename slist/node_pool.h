@@ -0,0 +1,282 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Slab arena for fixed-size list nodes.
+//
+// Memory is requested from the system in slabs that grow geometrically
+// (SlabMin cells up to SlabMax cells), cells are handed out with a bump
+// pointer and recycled through an intrusive free list. Nodes allocated
+// back to back therefore end up next to each other in memory, and
+// release() gives every slab back in one pass.
+//
+// The arena is untyped: its cell size is fixed by the first allocation,
+// which lets a node_pool<T> be rebound to a container's node type and
+// still share one arena.
+template<std::size_t SlabMin, std::size_t SlabMax>
+class node_arena
+{
+	struct Cell { Cell* next; };
+
+	struct Slab
+	{
+		Slab* next;
+		std::size_t cells;
+	};
+
+public:
+	typedef std::size_t size_type;
+
+	node_arena() noexcept:
+		refs(1), live(0), cell_size(0), cell_align(0),
+		slabs(nullptr), free_list(nullptr), bump(nullptr), bump_end(nullptr),
+		next_cells(SlabMin) {}
+
+	~node_arena() { release(); }
+
+	node_arena(const node_arena&) = delete;
+	node_arena& operator=(const node_arena&) = delete;
+
+	// fix the cell layout on first use; every later user must agree with it
+	void bind(size_type size, size_type align)
+	{
+		if(size < sizeof(Cell)) size = sizeof(Cell);
+		if(align < alignof(Cell)) align = alignof(Cell);
+		size = (size + align - 1) / align * align;
+
+		if(cell_size == 0)
+		{
+			cell_size = size;
+			cell_align = align;
+		}
+		else if(cell_size != size || cell_align < align)
+		{
+			throw std::logic_error("node_arena: shared between node types of different size");
+		}
+	}
+
+	// allocate storage for n contiguous cells
+	void* allocate(size_type n)
+	{
+		if(n == 1 && free_list != nullptr)
+		{
+			Cell* c = free_list;
+			free_list = c->next;
+			++live;
+			return c;
+		}
+		if(static_cast<size_type>(bump_end - bump) < n * cell_size)
+			grow(n);
+		void* c = bump;
+		bump += n * cell_size;
+		live += n;
+		return c;
+	}
+
+	// return storage for n contiguous cells to the free list
+	void deallocate(void* p, size_type n) noexcept
+	{
+		unsigned char* c = static_cast<unsigned char*>(p);
+		for(size_type i = 0; i < n; ++i)
+			push_free(c + i * cell_size);
+		live -= n;
+	}
+
+	// give every slab back to the system; all outstanding cells become invalid
+	void release() noexcept
+	{
+		while(slabs != nullptr)
+		{
+			Slab* s = slabs;
+			slabs = s->next;
+			::operator delete(static_cast<void*>(s), std::align_val_t(slab_align()));
+		}
+		free_list = nullptr;
+		bump = bump_end = nullptr;
+		next_cells = SlabMin;
+		live = 0;
+	}
+
+	// number of cells currently handed out
+	size_type outstanding() const noexcept
+		{ return live; }
+
+	size_type refs;
+
+private:
+	size_type slab_align() const noexcept
+		{ return cell_align > alignof(Slab) ? cell_align : alignof(Slab); }
+
+	void push_free(unsigned char* p) noexcept
+	{
+		Cell* c = reinterpret_cast<Cell*>(p);
+		c->next = free_list;
+		free_list = c;
+	}
+
+	void grow(size_type n)
+	{
+		// leftovers of the current slab are recycled rather than lost
+		while(static_cast<size_type>(bump_end - bump) >= cell_size)
+		{
+			push_free(bump);
+			bump += cell_size;
+		}
+
+		// slab header padded so the first cell is suitably aligned
+		size_type align = slab_align();
+		size_type header = (sizeof(Slab) + align - 1) / align * align;
+		size_type cells = next_cells > n ? next_cells : n;
+
+		void* raw = ::operator new(header + cells * cell_size, std::align_val_t(align));
+		Slab* s = static_cast<Slab*>(raw);
+		s->next = slabs;
+		s->cells = cells;
+		slabs = s;
+
+		bump = static_cast<unsigned char*>(raw) + header;
+		bump_end = bump + cells * cell_size;
+		if(next_cells < SlabMax)
+			next_cells = next_cells * 2 < SlabMax ? next_cells * 2 : SlabMax;
+	}
+
+	size_type live;
+	size_type cell_size;
+	size_type cell_align;
+	Slab* slabs;
+	Cell* free_list;
+	unsigned char* bump;
+	unsigned char* bump_end;
+	size_type next_cells;
+};
+
+// Allocator handle onto a reference counted node_arena.
+//
+// Copies and rebinds share the arena, so lists built from the same pool
+// can hand nodes to each other (splice, merge) without copying. Copying a
+// container, on the other hand, starts a fresh arena through
+// select_on_container_copy_construction so copies keep their own locality.
+template<class T, std::size_t SlabMin = 64, std::size_t SlabMax = 4096>
+class node_pool
+{
+	template<class U, std::size_t Min, std::size_t Max>
+	friend class node_pool;
+
+	typedef node_arena<SlabMin, SlabMax> arena_type;
+
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::false_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_swap;
+	typedef std::false_type is_always_equal;
+
+	template<class U>
+	struct rebind { typedef node_pool<U, SlabMin, SlabMax> other; };
+
+	node_pool():
+		arena(new arena_type()) {}
+	node_pool(const node_pool& other) noexcept:
+		arena(other.arena) { acquire(); }
+	template<class U>
+	node_pool(const node_pool<U, SlabMin, SlabMax>& other) noexcept:
+		arena(other.arena) { acquire(); }
+	node_pool(node_pool&& other) noexcept:
+		arena(other.arena) { other.arena = nullptr; }
+
+	node_pool& operator=(const node_pool& other) noexcept
+	{
+		if(arena != other.arena)
+		{
+			drop();
+			arena = other.arena;
+			acquire();
+		}
+		return *this;
+	}
+	node_pool& operator=(node_pool&& other) noexcept
+	{
+		if(this != &other)
+		{
+			drop();
+			arena = other.arena;
+			other.arena = nullptr;
+		}
+		return *this;
+	}
+
+	~node_pool() { drop(); }
+
+	// a copied container gets an arena of its own
+	node_pool select_on_container_copy_construction() const
+		{ return node_pool(); }
+
+	// allocate storage for n contiguous objects
+	T* allocate(size_type n)
+	{
+		if(arena == nullptr) arena = new arena_type();
+		arena->bind(sizeof(T), alignof(T));
+		return static_cast<T*>(arena->allocate(n));
+	}
+
+	// return storage for n contiguous objects to the free list
+	void deallocate(T* p, size_type n) noexcept
+		{ arena->deallocate(p, n); }
+
+	// give every slab back to the system; all outstanding cells become invalid
+	void release() noexcept
+		{ if(arena != nullptr) arena->release(); }
+
+	// number of objects currently allocated from the shared arena
+	size_type outstanding() const noexcept
+		{ return arena != nullptr ? arena->outstanding() : 0; }
+
+	template<class U>
+	bool operator==(const node_pool<U, SlabMin, SlabMax>& rhs) const noexcept
+		{ return arena == rhs.arena; }
+	template<class U>
+	bool operator!=(const node_pool<U, SlabMin, SlabMax>& rhs) const noexcept
+		{ return arena != rhs.arena; }
+
+private:
+	void acquire() noexcept
+		{ if(arena != nullptr) ++arena->refs; }
+	void drop() noexcept
+	{
+		if(arena != nullptr && --arena->refs == 0)
+			delete arena;
+		arena = nullptr;
+	}
+
+	arena_type* arena;
+};
+
+// true if storage from one allocate(n) may be handed back an object at a
+// time, so a container can take many nodes in one call and free them singly
+template<class A>
+struct frees_singly: std::false_type {};
+template<class T, std::size_t SlabMin, std::size_t SlabMax>
+struct frees_singly<node_pool<T, SlabMin, SlabMax>>: std::true_type {};
+
+// true if the allocator can drop all of its storage at once through release()
+// and report how much of it is outstanding
+template<class A, class = void>
+struct is_releasable: std::false_type {};
+template<class A>
+struct is_releasable<A, std::void_t<
+	decltype(std::declval<A&>().release()),
+	decltype(std::declval<const A&>().outstanding())>>: std::true_type {};
+
+#endif
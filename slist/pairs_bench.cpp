@@ -0,0 +1,95 @@
+// All-pairs airport distances: scaling of all_pairs_extremes with threads.
+//
+// usage: pairs_bench [max_threads] [csv]
+//
+// First checks the engine against plain distanceEarth loops on the first
+// 2000 airports, with the distance matrix included. Then it runs the full
+// set on 1, 2, 4 ... threads up to the hardware thread count (or argv[1]).
+// Output is CSV: threads,airports,pairs,ms,mpairs_per_s
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "airport.h"
+#include "airport_pairs.h"
+
+// brute-force check of the engine on airports[0, n)
+static bool verify(const std::vector<Airport>& all, std::size_t n)
+{
+	std::vector<Airport> airports(all.begin(), all.begin() + std::min(n, all.size()));
+	n = airports.size();
+	airport_store store(airports.begin(), airports.end());
+	airport_extremes got = all_pairs_extremes(store, 3, 96);
+
+	std::vector<double> matrix(n * n);
+	distance_matrix(store, matrix.data(), 3, 96);
+
+	double far = -1, close = 1e300, err = 0;
+	bool ok = true;
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		double nn = 1e300;
+		for(std::size_t j = 0; j < n; ++j)
+		{
+			double d = distanceEarth(airports[i].latitude, airports[i].longitude, airports[j].latitude, airports[j].longitude);
+			err = std::max(err, std::abs(d - matrix[i * n + j]));
+			if(i == j) continue;
+			nn = std::min(nn, d);
+			if(i < j)
+			{
+				far = std::max(far, d);
+				close = std::min(close, d);
+			}
+		}
+		// chord order and haversine order agree to within rounding
+		ok = ok && std::abs(got.nearest[i].km - nn) < 1e-6;
+	}
+	ok = ok && std::abs(got.farthest.km - far) < 1e-6 && std::abs(got.closest.km - close) < 1e-6 && err < 1e-3;
+
+	std::cerr << "verify " << n << " airports: farthest " << got.farthest.km << " km, closest "
+		<< got.closest.km << " km, matrix max error " << err * 1000 << " m" << (ok ? "" : " FAILED") << std::endl;
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned max_threads = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	const char* path = (argc > 2) ? argv[2] : "./USAirportCodes.csv";
+	if(max_threads == 0) max_threads = 4;
+
+	std::vector<Airport> airports;
+	if(!load_airports(path, airports) || airports.empty())
+	{
+		std::cout << "Error opening file" << std::endl;
+		return 1;
+	}
+
+	bool ok = verify(airports, 2000);
+
+	airport_store store(airports.begin(), airports.end());
+	const std::size_t n = store.size();
+	const double pairs = double(n) * (n - 1) / 2;
+
+	std::cout << "threads,airports,pairs,ms,mpairs_per_s" << std::endl;
+	airport_extremes result;
+	for(unsigned t = 1; t <= max_threads; t *= 2)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		result = all_pairs_extremes(store, t);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << t << ',' << n << ',' << std::size_t(pairs) << ',' << elapsed.count() << ','
+			<< pairs / elapsed.count() / 1000.0 << std::endl;
+	}
+
+	const airport_pair& f = result.farthest;
+	const airport_pair& c = result.closest;
+	std::cerr << "farthest: " << store.code(f.first) << " - " << store.code(f.second) << " " << f.km << " km" << std::endl;
+	std::cerr << "closest: " << store.code(c.first) << " - " << store.code(c.second) << " " << c.km << " km" << std::endl;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Parallel reductions over an slist: scaling of parallel_transform_reduce
+// and parallel_count_if with threads.
+//
+// usage: parallel_bench [max_threads] [elements] [csv]
+//
+// Builds a list of great-circle distances between airport pairs (10M by
+// default) and sums it serially, then on 1, 2, 4 ... workers up to the
+// hardware thread count (or argv[1]), each with segments cut once up front.
+// Output is CSV: threads,elements,sum_ms,count_ms,speedup
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "airport.h"
+#include "slist_parallel.h"
+
+int main(int argc, char* argv[])
+{
+	unsigned max_threads = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	std::size_t n = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 10000000;
+	const char* path = (argc > 3) ? argv[3] : "./USAirportCodes.csv";
+	if(max_threads == 0) max_threads = 4;
+
+	std::vector<Airport> airports;
+	if(!load_airports(path, airports) || airports.empty())
+	{
+		std::cout << "Error opening file" << std::endl;
+		return 1;
+	}
+
+	slist<double> km;
+	const std::size_t m = airports.size();
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		const Airport& a = airports[i % m];
+		const Airport& b = airports[(i * 7919 + 1) % m];
+		km.push_back(distanceEarth(a.latitude, a.longitude, b.latitude, b.longitude));
+	}
+
+	// read-only from here on: the segments hold const_iterators
+	const slist<double>& data = km;
+
+	typedef std::chrono::steady_clock clock;
+	typedef std::chrono::duration<double, std::milli> ms;
+
+	clock::time_point start = clock::now();
+	double serial = 0;
+	std::size_t serial_far = 0;
+	for(slist<double>::const_iterator it = data.cbegin(); it != data.cend(); ++it)
+	{
+		serial += *it;
+		serial_far += (*it > 1000.0);
+	}
+	double serial_ms = ms(clock::now() - start).count();
+	std::cerr << "serial: " << serial_ms << " ms, sum " << serial << " km, " << serial_far << " over 1000 km" << std::endl;
+
+	bool ok = true;
+	std::cout << "threads,elements,sum_ms,count_ms,speedup" << std::endl;
+	for(unsigned t = 1; t <= max_threads; t *= 2)
+	{
+		worker_pool pool(t);
+		list_segments<slist<double>::const_iterator> segs = segments(data, t * slist_segments_per_worker);
+
+		start = clock::now();
+		double sum = parallel_transform_reduce(segs, 0.0,
+			[](double a, double b) { return a + b; }, [](double d) { return d; }, pool);
+		double sum_ms = ms(clock::now() - start).count();
+
+		start = clock::now();
+		std::size_t far = parallel_count_if(segs, [](double d) { return d > 1000.0; }, pool);
+		double count_ms = ms(clock::now() - start).count();
+
+		// segment sums are added in a different order than the serial loop
+		ok = ok && std::abs(sum - serial) <= 1e-9 * serial && far == serial_far;
+		std::cout << t << ',' << n << ',' << sum_ms << ',' << count_ms << ',' << serial_ms / sum_ms << std::endl;
+	}
+
+	if(!ok) std::cerr << "parallel results differ from serial" << std::endl;
+	return ok ? 0 : 1;
+}
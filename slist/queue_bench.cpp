@@ -0,0 +1,111 @@
+// Throughput of cqueue against an slist behind one mutex.
+//
+// For each thread count P, P producers push ITEMS values each while P
+// consumers pop until everything has been taken, for P = 1, 2, 4 ... up
+// to the hardware thread count (or argv[2]). Every run checks that
+// each value came out exactly once, so the benchmark doubles as a stress
+// run for the queue. Output is CSV: queue,threads,items,ms,mops
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cqueue.h"
+#include "slist.h"
+
+// slist with one big lock, the setup cqueue replaces
+template<class T>
+class locked_slist
+{
+public:
+	void push(const T& data)
+	{
+		std::lock_guard<std::mutex> lock(m);
+		l.push_back(data);
+	}
+
+	bool try_pop(T& out)
+	{
+		std::lock_guard<std::mutex> lock(m);
+		if(l.empty()) return false;
+		out = l.front();
+		l.pop_front();
+		return true;
+	}
+
+private:
+	std::mutex m;
+	slist<T> l;
+};
+
+template<class Queue>
+bool run(const char* name, unsigned threads, unsigned long items)
+{
+	Queue q;
+	const unsigned long total = items * threads;
+	std::vector<std::atomic<unsigned char>> seen(total);
+	std::atomic<unsigned long> popped(0);
+	std::atomic<bool> duplicate(false);
+	std::atomic<bool> go(false);
+
+	std::vector<std::thread> pool;
+	for(unsigned p = 0; p < threads; ++p)
+	{
+		pool.emplace_back([&, p]()
+		{
+			while(!go.load()) std::this_thread::yield();
+			for(unsigned long i = 0; i < items; ++i)
+				q.push(p * items + i);
+		});
+	}
+	for(unsigned c = 0; c < threads; ++c)
+	{
+		pool.emplace_back([&]()
+		{
+			while(!go.load()) std::this_thread::yield();
+			unsigned long v;
+			while(popped.load(std::memory_order_relaxed) < total)
+			{
+				if(q.try_pop(v))
+				{
+					if(seen[v].exchange(1) != 0) duplicate.store(true);
+					popped.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	go.store(true);
+	for(std::thread& t: pool) t.join();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	bool ok = !duplicate.load() && popped.load() == total;
+	for(unsigned long i = 0; ok && i < total; ++i)
+		ok = seen[i].load() == 1;
+
+	std::cout << name << ',' << threads << ',' << total << ',' << elapsed.count() << ','
+		<< (2.0 * total / elapsed.count() / 1000.0) << (ok ? "" : ",FAILED") << std::endl;
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long items = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	unsigned max_threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+	if(max_threads == 0) max_threads = 4;
+
+	bool ok = true;
+	std::cout << "queue,threads,items,ms,mops" << std::endl;
+	for(unsigned t = 1; t <= max_threads; t *= 2)
+	{
+		ok = run<cqueue<unsigned long>>("cqueue", t, items) && ok;
+		ok = run<locked_slist<unsigned long>>("locked_slist", t, items) && ok;
+	}
+
+	return ok ? 0 : 1;
+}
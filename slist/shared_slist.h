@@ -0,0 +1,687 @@
+#ifndef SHARED_SLIST_H
+#define SHARED_SLIST_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "format.h"
+
+// Persistent singly linked list: copies share their nodes, so a copy costs
+// one reference count bump whatever the length, and a snapshot handed to a
+// reader is never disturbed by the writer that made it.
+//
+// Every node counts the lists and nodes that point at it. A list may edit
+// a node in place only if it is the sole owner of it and of every node
+// before it; those nodes form the list's owned prefix. A change at index k
+// first clones whatever part of [0, k) is shared, and the clones point at
+// the untouched rest, so only the path to the change is copied. A list
+// that is not shared edits in place like an slist.
+//
+// The front is O(1). Other positions cost the walk to them, plus the clone
+// of the shared part of that walk. push_back is O(1) while the whole list
+// is owned, as when building it, but the first push_back after a copy
+// clones every node.
+//
+// Counts are atomic, so copies may be read, changed and destroyed on
+// different threads, as long as one list object is not changed on one
+// thread while used on another. For that reason the default allocator is
+// std::allocator, not node_pool: a node_pool may only be used on one thread,
+// which would keep every copy there too.
+template<class T, class Alloc = std::allocator<T>>
+class shared_slist
+{
+	struct Node
+	{
+		template<class... Args>
+		Node(Node* _next, Args&&... args):
+			refs(1), next(_next), data(std::forward<Args>(args)...) {}
+
+		std::atomic<std::size_t> refs;
+		Node* next;
+		T data;
+	};
+
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Alloc allocator_type;
+
+private:
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> node_allocator;
+	typedef std::allocator_traits<node_allocator> node_traits;
+
+	Node* first;
+	Node* last;
+	size_type count;
+	// length of a prefix this list owns outright; a copy of the list resets
+	// it on both sides, and releases elsewhere can only make it an underestimate
+	mutable std::atomic<size_type> owned;
+	node_allocator alloc;
+
+	template<class... Args>
+	Node* create_node(Node* next, Args&&... args);
+	void destroy_node(Node*);
+
+	// take a reference to n, if any
+	static void retain(Node* n);
+	// drop a reference to n, destroying it and any nodes only it kept alive
+	void release(Node* n);
+
+	// the link to index k, after cloning the shared part of [0, k);
+	// before is the node ahead of it, or nullptr at index 0
+	Node** path(size_type k, Node*& before);
+
+	void steal(shared_slist& other) noexcept;
+
+public:
+	class const_iterator;
+	typedef const_iterator iterator;
+
+	shared_slist();
+	explicit shared_slist(const Alloc& a);
+	template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	shared_slist(InputIt first, InputIt last, const Alloc& a = Alloc());
+	shared_slist(std::initializer_list<T> values, const Alloc& a = Alloc());
+	// O(1): the copy shares every node
+	shared_slist(const shared_slist& other);
+	shared_slist(shared_slist&& other) noexcept;
+
+	shared_slist& operator=(const shared_slist& other);
+	shared_slist& operator=(shared_slist&& other);
+
+	template<class E, class A>
+	friend bool operator==(const shared_slist<E, A>&, const shared_slist<E, A>&);
+	template<class E, class A>
+	friend bool operator!=(const shared_slist<E, A>&, const shared_slist<E, A>&);
+	template<class E, class A>
+	friend std::ostream& operator<<(std::ostream& os, const shared_slist<E, A>& s_l);
+
+	// return true if empty
+	bool empty() const;
+
+	// return size of list
+	size_type size() const;
+
+	// true if no other list shares any of the nodes; walks the list
+	bool unique() const;
+
+	// clear list
+	void clear();
+
+	void swap(shared_slist& other) noexcept;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	const_reference front() const;
+	const_reference back() const;
+
+	// element at index k; at() throws std::out_of_range past the end
+	const_reference operator[](size_type k) const;
+	const_reference at(size_type k) const;
+
+	// replace the element at index k
+	void set(size_type k, const T&);
+	void set(size_type k, T&&);
+
+	// insert at index k, 0 to size(), moving later elements up one
+	void insert(size_type k, const T&);
+	void insert(size_type k, T&&);
+	template<class... Args>
+	void emplace(size_type k, Args&&...);
+
+	// erase the element at index k
+	void erase(size_type k);
+
+	void push_front(const T&);
+	void push_front(T&&);
+	template<class... Args>
+	void emplace_front(Args&&...);
+	void pop_front();
+
+	void push_back(const T&);
+	void push_back(T&&);
+	template<class... Args>
+	void emplace_back(Args&&...);
+	void pop_back();
+
+	std::string to_string() const;
+
+	// destroy
+	~shared_slist();
+};
+
+template<class T, class Alloc>
+class shared_slist<T, Alloc>::const_iterator
+{
+	friend class shared_slist;
+
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	const_iterator(const Node* _node = nullptr):
+		node(_node) {}
+
+	inline bool operator==(const const_iterator& rhs) const
+		{ return node == rhs.node; }
+	inline bool operator!=(const const_iterator& rhs) const
+		{ return node != rhs.node; }
+
+	inline const_iterator& operator++()
+	{
+		node = node->next;
+		return *this;
+	}
+	inline const_iterator operator++(int)
+	{
+		const_iterator tmp(*this);
+		node = node->next;
+		return tmp;
+	}
+
+	inline reference operator*() const
+		{ return node->data; }
+	inline pointer operator->() const
+		{ return &node->data; }
+
+private:
+	const Node* node;
+};
+
+// lists sharing their first node share every node, so they are equal at once
+template<class T, class Alloc>
+bool operator==(const shared_slist<T, Alloc>& lhs, const shared_slist<T, Alloc>& rhs)
+{
+	if(lhs.count != rhs.count) return false;
+	if(lhs.first == rhs.first) return true;
+	return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+template<class T, class Alloc>
+inline bool operator!=(const shared_slist<T, Alloc>& lhs, const shared_slist<T, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+template<class T, class Alloc>
+inline std::ostream& operator<<(std::ostream& os, const shared_slist<T, Alloc>& s_l)
+	{ return format_stream(os, s_l.cbegin(), s_l.cend()); }
+
+// Constructor
+template<class T, class Alloc>
+shared_slist<T, Alloc>::shared_slist():
+	first(nullptr), last(nullptr), count(0), owned(0), alloc() {}
+
+template<class T, class Alloc>
+shared_slist<T, Alloc>::shared_slist(const Alloc& a):
+	first(nullptr), last(nullptr), count(0), owned(0), alloc(a) {}
+
+template<class T, class Alloc>
+template<class InputIt, class>
+shared_slist<T, Alloc>::shared_slist(InputIt _first, InputIt _last, const Alloc& a):
+	first(nullptr), last(nullptr), count(0), owned(0), alloc(a)
+{
+	try
+	{
+		for(; _first != _last; ++_first)
+			emplace_back(*_first);
+	}
+	catch(...)
+	{
+		clear();
+		throw;
+	}
+}
+
+template<class T, class Alloc>
+shared_slist<T, Alloc>::shared_slist(std::initializer_list<T> values, const Alloc& a):
+	shared_slist(values.begin(), values.end(), a) {}
+
+// copy constructor
+// whichever list lets go of a node last frees it, so lists sharing nodes
+// share the allocator too, rather than asking for a fresh one
+template<class T, class Alloc>
+shared_slist<T, Alloc>::shared_slist(const shared_slist& other):
+	first(other.first), last(other.last), count(other.count), owned(0), alloc(other.alloc)
+{
+	retain(first);
+	other.owned.store(0, std::memory_order_relaxed);
+}
+
+// move constructor
+template<class T, class Alloc>
+shared_slist<T, Alloc>::shared_slist(shared_slist&& other) noexcept:
+	first(nullptr), last(nullptr), count(0), owned(0), alloc(std::move(other.alloc))
+{
+	steal(other);
+}
+
+// copy assignment
+template<class T, class Alloc>
+shared_slist<T, Alloc>& shared_slist<T, Alloc>::operator=(const shared_slist& other)
+{
+	if(this == &other) return *this;
+
+	if constexpr(!node_traits::propagate_on_container_copy_assignment::value)
+	{
+		// nodes cannot be shared across allocators that cannot free each other's
+		if(alloc != other.alloc)
+		{
+			clear();
+			for(const_iterator it = other.cbegin(); it != other.cend(); ++it)
+				emplace_back(*it);
+			return *this;
+		}
+	}
+
+	// take the new nodes before dropping the old, which may keep them alive
+	retain(other.first);
+	clear();
+	if constexpr(node_traits::propagate_on_container_copy_assignment::value)
+		alloc = other.alloc;
+	first = other.first;
+	last = other.last;
+	count = other.count;
+	other.owned.store(0, std::memory_order_relaxed);
+	return *this;
+}
+
+// move assignment
+template<class T, class Alloc>
+shared_slist<T, Alloc>& shared_slist<T, Alloc>::operator=(shared_slist&& other)
+{
+	if(this == &other) return *this;
+
+	clear();
+	if constexpr(node_traits::propagate_on_container_move_assignment::value)
+	{
+		alloc = std::move(other.alloc);
+		steal(other);
+	}
+	else
+	{
+		if(alloc == other.alloc)
+		{
+			steal(other);
+		}
+		else
+		{
+			// storage cannot change hands, so copy what other may still share
+			for(const_iterator it = other.cbegin(); it != other.cend(); ++it)
+				emplace_back(*it);
+			other.clear();
+		}
+	}
+	return *this;
+}
+
+// Destructor
+template<class T, class Alloc>
+inline shared_slist<T, Alloc>::~shared_slist()
+	{ clear(); }
+
+// steal(other)				//takes over other's nodes, leaving it empty
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::steal(shared_slist& other) noexcept
+{
+	first = other.first;
+	last = other.last;
+	count = other.count;
+	owned.store(other.owned.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	other.first = other.last = nullptr;
+	other.count = 0;
+	other.owned.store(0, std::memory_order_relaxed);
+}
+
+// create_node(next, args)	//allocates a node owned by its creator
+template<class T, class Alloc>
+template<class... Args>
+typename shared_slist<T, Alloc>::Node* shared_slist<T, Alloc>::create_node(Node* next, Args&&... args)
+{
+	Node* n = node_traits::allocate(alloc, 1);
+	try
+	{
+		node_traits::construct(alloc, n, next, std::forward<Args>(args)...);
+	}
+	catch(...)
+	{
+		node_traits::deallocate(alloc, n, 1);
+		throw;
+	}
+	return n;
+}
+
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::destroy_node(Node* n)
+{
+	node_traits::destroy(alloc, n);
+	node_traits::deallocate(alloc, n, 1);
+}
+
+// retain(node)				//counts one more reference to a node
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::retain(Node* n)
+{
+	if(n != nullptr) n->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// release(node)			//drops a reference, freeing the run of nodes nothing else holds
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::release(Node* n)
+{
+	// a loop, not recursion, so a long list cannot overflow the stack
+	while(n != nullptr && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Node* next = n->next;
+		destroy_node(n);
+		n = next;
+	}
+}
+
+// path(index, before)		//clones the shared part of [0, k) and returns the link to index k
+template<class T, class Alloc>
+typename shared_slist<T, Alloc>::Node** shared_slist<T, Alloc>::path(size_type k, Node*& before)
+{
+	Node** link = &first;
+	before = nullptr;
+	size_type i = 0;
+
+	// the owned prefix is edited in place
+	const size_type known = owned.load(std::memory_order_relaxed);
+	for(; i < k && (i < known || (*link)->refs.load(std::memory_order_acquire) == 1); ++i)
+	{
+		before = *link;
+		link = &before->next;
+	}
+	if(i == k) return link;
+
+	// clone the rest of the way; the last clone takes a reference on the
+	// first node left behind and the list lets go of the one it cloned from
+	Node* shared = *link;
+	Node* chain = nullptr;
+	Node* chain_last = nullptr;
+	const Node* src = shared;
+	try
+	{
+		for(; i < k; ++i, src = src->next)
+		{
+			Node* c = create_node(nullptr, src->data);
+			if(chain_last != nullptr)
+				chain_last->next = c;
+			else
+				chain = c;
+			chain_last = c;
+		}
+	}
+	catch(...)
+	{
+		release(chain);
+		throw;
+	}
+
+	chain_last->next = const_cast<Node*>(src);
+	retain(chain_last->next);
+	*link = chain;
+	if(src == nullptr) last = chain_last;
+	release(shared);
+
+	if(known < k) owned.store(k, std::memory_order_relaxed);
+	before = chain_last;
+	return &chain_last->next;
+}
+
+// empty()					//Returns whether or not this list is empty.
+template<class T, class Alloc>
+inline bool shared_slist<T, Alloc>::empty() const
+	{ return count == 0; }
+
+// size()					//Returns the number of elements in this list.
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::size_type shared_slist<T, Alloc>::size() const
+	{ return count; }
+
+// unique()					//Returns true if this list shares no node with another.
+template<class T, class Alloc>
+bool shared_slist<T, Alloc>::unique() const
+{
+	for(const Node* n = first; n != nullptr; n = n->next)
+		if(n->refs.load(std::memory_order_acquire) != 1) return false;
+	return true;
+}
+
+// clear()					//Removes all elements from this list.
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::clear()
+{
+	release(first);
+	first = last = nullptr;
+	count = 0;
+	owned.store(0, std::memory_order_relaxed);
+}
+
+// swap(other)				//Exchanges the contents of two lists in O(1).
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::swap(shared_slist& other) noexcept
+{
+	using std::swap;
+	swap(first, other.first);
+	swap(last, other.last);
+	swap(count, other.count);
+	size_type o = owned.load(std::memory_order_relaxed);
+	owned.store(other.owned.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	other.owned.store(o, std::memory_order_relaxed);
+	if constexpr(node_traits::propagate_on_container_swap::value)
+		swap(alloc, other.alloc);
+}
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_iterator shared_slist<T, Alloc>::begin() const
+	{ return const_iterator(first); }
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_iterator shared_slist<T, Alloc>::end() const
+	{ return const_iterator(nullptr); }
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_iterator shared_slist<T, Alloc>::cbegin() const
+	{ return const_iterator(first); }
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_iterator shared_slist<T, Alloc>::cend() const
+	{ return const_iterator(nullptr); }
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_reference shared_slist<T, Alloc>::front() const
+	{ return first->data; }
+
+template<class T, class Alloc>
+inline typename shared_slist<T, Alloc>::const_reference shared_slist<T, Alloc>::back() const
+	{ return last->data; }
+
+// get(index)				//Returns the element at the specified index in this list.
+template<class T, class Alloc>
+typename shared_slist<T, Alloc>::const_reference shared_slist<T, Alloc>::operator[](size_type k) const
+{
+	const Node* n = first;
+	while(k-- > 0) n = n->next;
+	return n->data;
+}
+
+template<class T, class Alloc>
+typename shared_slist<T, Alloc>::const_reference shared_slist<T, Alloc>::at(size_type k) const
+{
+	if(k >= count) throw std::out_of_range("shared_slist::at");
+	return (*this)[k];
+}
+
+// set(index, value)		//Replaces the element at the specified index; a shared node is replaced, not copied.
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::set(size_type k, const T& value)
+{
+	Node* before;
+	Node** link = path(k, before);
+	Node* n = *link;
+	if(n->refs.load(std::memory_order_acquire) == 1)
+	{
+		n->data = value;
+	}
+	else
+	{
+		Node* c = create_node(n->next, value);
+		retain(c->next);
+		*link = c;
+		if(n == last) last = c;
+		release(n);
+	}
+	if(owned.load(std::memory_order_relaxed) <= k) owned.store(k + 1, std::memory_order_relaxed);
+}
+
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::set(size_type k, T&& value)
+{
+	Node* before;
+	Node** link = path(k, before);
+	Node* n = *link;
+	if(n->refs.load(std::memory_order_acquire) == 1)
+	{
+		n->data = std::move(value);
+	}
+	else
+	{
+		Node* c = create_node(n->next, std::move(value));
+		retain(c->next);
+		*link = c;
+		if(n == last) last = c;
+		release(n);
+	}
+	if(owned.load(std::memory_order_relaxed) <= k) owned.store(k + 1, std::memory_order_relaxed);
+}
+
+// insert(index, value)		//Inserts a new value at the specified index in this list.
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::insert(size_type k, const T& value)
+	{ emplace(k, value); }
+
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::insert(size_type k, T&& value)
+	{ emplace(k, std::move(value)); }
+
+// emplace(index, args)		//Constructs a new value in place at the specified index.
+template<class T, class Alloc>
+template<class... Args>
+void shared_slist<T, Alloc>::emplace(size_type k, Args&&... args)
+{
+	Node* before;
+	Node** link = path(k, before);
+	// the new node takes over the link's reference to what follows
+	Node* n = create_node(*link, std::forward<Args>(args)...);
+	*link = n;
+	if(k == count) last = n;
+	++count;
+
+	size_type o = owned.load(std::memory_order_relaxed);
+	owned.store((o > k ? o : k) + 1, std::memory_order_relaxed);
+}
+
+// erase(index)				//Erases the element at the specified index from this list.
+template<class T, class Alloc>
+void shared_slist<T, Alloc>::erase(size_type k)
+{
+	Node* before;
+	Node** link = path(k, before);
+	Node* n = *link;
+	if(n == last) last = before;
+	*link = n->next;
+	// the link now holds n's reference to its successor; keep it if n lives on
+	if(n->refs.load(std::memory_order_acquire) == 1)
+	{
+		n->next = nullptr;
+		destroy_node(n);
+	}
+	else
+	{
+		retain(*link);
+		release(n);
+	}
+	--count;
+
+	size_type o = owned.load(std::memory_order_relaxed);
+	owned.store(o > k ? o - 1 : k, std::memory_order_relaxed);
+}
+
+// push_front(value)		//Adds a new value to the front of this list.
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::push_front(const T& value)
+	{ emplace(0, value); }
+
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::push_front(T&& value)
+	{ emplace(0, std::move(value)); }
+
+template<class T, class Alloc>
+template<class... Args>
+inline void shared_slist<T, Alloc>::emplace_front(Args&&... args)
+	{ emplace(0, std::forward<Args>(args)...); }
+
+// pop_front()				//Removes the first element of this list.
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::pop_front()
+	{ erase(0); }
+
+// push_back(value)			//Adds a new value to the end of this list.
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::push_back(const T& value)
+	{ emplace_back(value); }
+
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::push_back(T&& value)
+	{ emplace_back(std::move(value)); }
+
+template<class T, class Alloc>
+template<class... Args>
+void shared_slist<T, Alloc>::emplace_back(Args&&... args)
+{
+	// an owned list appends at last without walking to it
+	if(owned.load(std::memory_order_relaxed) == count)
+	{
+		Node* n = create_node(nullptr, std::forward<Args>(args)...);
+		if(last != nullptr)
+			last->next = n;
+		else
+			first = n;
+		last = n;
+		++count;
+		owned.store(count, std::memory_order_relaxed);
+	}
+	else
+	{
+		emplace(count, std::forward<Args>(args)...);
+	}
+}
+
+// pop_back()				//Removes the last element of this list.
+template<class T, class Alloc>
+inline void shared_slist<T, Alloc>::pop_back()
+	{ erase(count - 1); }
+
+// toString()				//Converts the list to a printable string representation.
+template<class T, class Alloc>
+std::string shared_slist<T, Alloc>::to_string() const
+	{ return format_string(cbegin(), cend()); }
+
+#endif
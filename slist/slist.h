@@ -2,50 +2,135 @@
 #define SLIST_H
 
 #include <iostream>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <string>
-#include <sstream>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
-template<class T>
+#include "compare.h"
+#include "format.h"
+#include "node_pool.h"
+
+// link layouts for slist: compact forward-only, or with a back link
+struct slist_flink
+{
+	slist_flink* next = nullptr;
+};
+
+struct slist_dlink
+{
+	slist_dlink* next = nullptr;
+	slist_dlink* prev = nullptr;
+};
+
+// Doubly selects the node layout at compile time. The default compact node
+// carries only a next pointer and gives forward iterators; Doubly = true
+// adds a prev pointer, kept current by every operation, for bidirectional
+// iterators and O(1) pop_back.
+template<class T, class Alloc = node_pool<T>, bool Doubly = false>
+class slist;
+
+// slist with back links and bidirectional iterators
+template<class T, class Alloc = node_pool<T>>
+using dslist = slist<T, Alloc, true>;
+
+template<class T, class Alloc, bool Doubly>
 class slist
 {
-	struct Node
+	// links only; the sentinel is a bare Link so it never holds a T
+	typedef typename std::conditional<Doubly, slist_dlink, slist_flink>::type Link;
+
+	struct Node: Link
 	{
-		Node(const T& _data, Node* _next = nullptr, Node* _prev = nullptr):
-			data(_data), next(_next), prev(_prev) {}
+		template<class... Args>
+		Node(Link* _next, Args&&... args):
+			Link{_next}, data(std::forward<Args>(args)...) {}
 
 		T data;
-		Node* next;
-		Node* prev;
 	};
 
-	Node* tail;
-
+public:
 	typedef T value_type;
 	typedef T* pointer;
 	typedef T& reference;
 	typedef const T& const_reference;
 	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Alloc allocator_type;
+
+private:
+	// element nodes come from Alloc rebound to Node
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> node_allocator;
+	typedef std::allocator_traits<node_allocator> node_traits;
+
+	// sentinel; head.next is the first element and the last element links back to it
+	Link head;
+	// last element, or &head when empty
+	Link* tail;
+	// number of elements, kept current by every insert/erase
+	size_type count;
+	node_allocator alloc;
+
+	// allocate and construct / destroy and deallocate a single node
+	template<class... Args>
+	Node* create_node(Link*, Args&&...);
+	void destroy_node(Link*);
+
+	// back link upkeep; compiles away for the compact layout
+	static void set_prev(Link* l, Link* prev);
+	// recompute every back link after a bulk relink
+	void relink_prev();
+	// point the sentinel at itself
+	void reset() noexcept;
+
+	// link a freshly created node in after pos
+	void link_after(Link* pos, Node* n);
+
+	// build the nodes of [first, last) as a chain ending in nullptr, setting
+	// chain_tail and n; inputs of known length take every node from one
+	// allocation when the allocator can free them one at a time
+	template<class InputIt>
+	Link* make_chain(InputIt first, InputIt last, Link*& chain_tail, size_type& n);
+	// link a chain from make_chain in after pos
+	void link_chain_after(Link* pos, Link* chain, Link* chain_tail, size_type n);
+	// destroy every node of a chain ending in nullptr
+	void destroy_chain(Link* chain);
+
+	// take over the nodes of other, leaving it empty
+	void steal(slist<T, Alloc, Doubly>& other) noexcept;
+
+	// merge two sorted, null terminated chains; ties keep lhs first
+	template<class Compare>
+	static Link* merge_chains(Link* lhs, Link* rhs, Compare& comp);
 
 public:
 	slist();
-	slist(const slist<T>& other);
+	explicit slist(const Alloc& a);
+	slist(const slist<T, Alloc, Doubly>& other);
+	slist(slist<T, Alloc, Doubly>&& other) noexcept;
+	// build from a range or a list of values, linked in one pass
+	template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	slist(InputIt first, InputIt last, const Alloc& a = Alloc());
+	slist(std::initializer_list<T> values, const Alloc& a = Alloc());
 
 	class iterator;
 	class const_iterator;
+	class view;
 
 	// assignment operator
-	slist<T>& operator=(const slist<T>& other);
+	slist<T, Alloc, Doubly>& operator=(const slist<T, Alloc, Doubly>& other);
+	slist<T, Alloc, Doubly>& operator=(slist<T, Alloc, Doubly>&& other);
 
 	// comparator specialization
-	template<class E>
-	friend bool operator==(const slist<E>&, const slist<E>&);
-	template<class E>
-	friend bool operator!=(const slist<E>&, const slist<E>&);
-	template<class E>
-	friend std::ostream& operator<<(std::ostream& os, const slist<E>& s_l);
+	template<class E, class A, bool D>
+	friend bool operator==(const slist<E, A, D>&, const slist<E, A, D>&);
+	template<class E, class A, bool D>
+	friend bool operator!=(const slist<E, A, D>&, const slist<E, A, D>&);
+	template<class E, class A, bool D>
+	friend std::ostream& operator<<(std::ostream& os, const slist<E, A, D>& s_l);
 
 	// swap the payload data of two nodes in the list
 	void swap(iterator& lhs, iterator& rhs);
@@ -57,8 +142,29 @@ public:
 	// reverse the list
 	void reverse();
 
+	// move nodes of other in after pos without copying
+	void splice_after(const const_iterator& pos, slist<T, Alloc, Doubly>& other);
+	void splice_after(const const_iterator& pos, slist<T, Alloc, Doubly>& other,
+		const const_iterator& first, const const_iterator& last);
+
+	// merge sorted other into this sorted list by relinking its nodes
+	void merge(slist<T, Alloc, Doubly>& other);
+	template<class Compare>
+	void merge(slist<T, Alloc, Doubly>& other, Compare comp);
+
+	// stable sort by relinking nodes; payloads are never copied or moved
+	void sort();
+	template<class Compare>
+	void sort(Compare comp);
+
 	// compare the list
-	bool equals(const slist<T>&) const;
+	bool equals(const slist<T, Alloc, Doubly>&) const;
+
+	// lexicographic order: <0, 0 or >0 as this list sorts before, with or after other
+	int compare(const slist<T, Alloc, Doubly>&) const;
+
+	// hash of the elements in order; lists that compare equal hash alike
+	std::size_t hash() const;
 
 	// return true if empty
 	bool empty() const;
@@ -87,18 +193,35 @@ public:
 	// erase first element in list
 	void pop_front();
 
+	// construct element in place at front / end / position
+	template<class... Args>
+	reference emplace_front(Args&&...);
+	template<class... Args>
+	reference emplace_back(Args&&...);
+	template<class... Args>
+	iterator emplace(const const_iterator&, Args&&...);
+
 	// insert element at position
 	void insert(const iterator&, const T&);
 	void insert(const iterator&, T&&);
 	void insert(const const_iterator&, const T&);
 	void insert(const const_iterator&, T&&);
+	// insert a range or a list of values at position
+	template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	void insert(const const_iterator&, InputIt first, InputIt last);
+	void insert(const const_iterator&, std::initializer_list<T>);
+
+	// replace the contents with a range or a list of values
+	template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+	void assign(InputIt first, InputIt last);
+	void assign(std::initializer_list<T>);
 
 	// return data at position
 	const_reference get(const iterator&) const;
 	const_reference get(const const_iterator&) const;
-	// return data in range
-	const std::vector<const_reference>& get(iterator&, const iterator&) const;
-	const std::vector<const_reference>& get(const_iterator&, const const_iterator&) const;
+	// return a non-owning view of the data in range
+	view get(const const_iterator&, const const_iterator&) const;
+	view get(const const_iterator&, size_type) const;
 
 	iterator begin();
 	const const_iterator begin() const;
@@ -115,10 +238,8 @@ public:
 	const T back() const;
 
 	// create sub list of this list
-	slist<T>& sub_list(slist<T>::iterator&, size_type);
-	slist<T>& sub_list(slist<T>::const_iterator&, size_type);
-	slist<T>& sub_list(slist<T>::iterator&, slist<T>::iterator&);
-	slist<T>& sub_list(slist<T>::const_iterator&, slist<T>::const_iterator&);
+	slist<T, Alloc, Doubly> sub_list(const const_iterator&, size_type) const;
+	slist<T, Alloc, Doubly> sub_list(const const_iterator&, const const_iterator&) const;
 
 	// set data of index
 	void set(iterator&, const T&);
@@ -126,9 +247,7 @@ public:
 	void set(const_iterator&, const T&);
 	void set(const_iterator&, T&&);
 	void set(iterator&, iterator&, const T&);
-	void set(iterator&, iterator&, T&&);
 	void set(const_iterator&, const_iterator&, const T&);
-	void set(const_iterator&, const_iterator&, T&&);
 
 	// erase data at index
 	void erase(iterator);
@@ -140,49 +259,45 @@ public:
 	std::string to_string();
 	std::string to_string() const;
 
+	// write the to_string text through an output iterator; returns its end
+	template<class OutputIt>
+	OutputIt format_to(OutputIt out) const;
+	// write at most n chars of the to_string text to buf, unterminated;
+	// returns the full length, so a result above n means it was cut short
+	size_type format_to(char* buf, size_type n) const;
+
 	// destroy
 	~slist();
 };
 
-template<class T>
-class slist<T>::const_iterator:
-	virtual public std::iterator<std::bidirectional_iterator_tag, T>
+// Iterators refer to the link *before* their element, so begin() is the
+// sentinel and end() is the last element. That keeps insert and erase at
+// an iterator O(1) on a singly linked ring.
+template<class T, class Alloc, bool Doubly>
+class slist<T, Alloc, Doubly>::const_iterator
 {
-
 	friend class slist;
 	friend class iterator;
 
+public:
+	typedef typename std::conditional<Doubly,
+		std::bidirectional_iterator_tag, std::forward_iterator_tag>::type iterator_category;
 	typedef T value_type;
-	typedef T* pointer;
-	typedef T& reference;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
 
-public:
-	const_iterator(const slist<T>::Node* _ref = nullptr):
+	const_iterator(const Link* _ref = nullptr):
 		ref(_ref) {}
 	const_iterator(const iterator& other):
 		ref(other.ref) {}
-	const_iterator(const const_iterator& other):
-		ref(other.ref) {}
 
-	inline bool operator==(const typename slist<T>::const_iterator& rhs)
-	{
-		return this->ref == rhs.ref;
-	}
-	inline bool operator!=(const typename slist<T>::const_iterator& rhs)
-	{
-		return this->ref != rhs.ref;
-	}
+	inline bool operator==(const const_iterator& rhs) const
+		{ return ref == rhs.ref; }
+	inline bool operator!=(const const_iterator& rhs) const
+		{ return ref != rhs.ref; }
 
-	inline const_iterator& operator=(const iterator& rhs)
-	{
-		this->ref = rhs.ref;
-	}
-	inline const_iterator& operator=(const const_iterator& rhs)
-	{
-		this->ref = rhs.ref;
-	}
-
-	inline const_iterator& operator++() 
+	inline const_iterator& operator++()
 	{
 		ref = ref->next;
 		return *this;
@@ -194,11 +309,14 @@ public:
 		return tmp;
 	}
 
+	// only the doubly linked layout can step backwards
+	template<bool D = Doubly, class = typename std::enable_if<D>::type>
 	inline const_iterator& operator--()
 	{
 		ref = ref->prev;
 		return *this;
 	}
+	template<bool D = Doubly, class = typename std::enable_if<D>::type>
 	inline const_iterator operator--(int)
 	{
 		const_iterator tmp(*this);
@@ -206,54 +324,38 @@ public:
 		return tmp;
 	}
 
-	inline const reference operator*() const
-	{
-		return ref->next->data;
-	}
-	inline const Node* operator->() const
-	{
-		return ref->next;
-	}
+	inline reference operator*() const
+		{ return static_cast<const Node*>(ref->next)->data; }
+	inline pointer operator->() const
+		{ return &static_cast<const Node*>(ref->next)->data; }
 
-	~const_iterator() {}
 private:
-	const Node* ref;
+	const Link* ref;
 };
 
-template<class T>
-class slist<T>::iterator:
-	virtual public std::iterator<std::bidirectional_iterator_tag, T>,
-	public slist<T>::const_iterator
+template<class T, class Alloc, bool Doubly>
+class slist<T, Alloc, Doubly>::iterator
 {
-
 	friend class slist;
 	friend class const_iterator;
 
+public:
+	typedef typename std::conditional<Doubly,
+		std::bidirectional_iterator_tag, std::forward_iterator_tag>::type iterator_category;
 	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
 	typedef T* pointer;
 	typedef T& reference;
 
-public:
-	iterator(slist<T>::Node* _ref = nullptr):
+	iterator(Link* _ref = nullptr):
 		ref(_ref) {}
-	iterator(const iterator& other):
-		ref(other.ref) {}
-
-	inline bool operator==(const typename slist<T>::iterator& rhs)
-	{
-		return this->ref == rhs.ref;
-	}
-	inline bool operator!=(const typename slist<T>::iterator& rhs)
-	{
-		return this->ref != rhs.ref;
-	}
 
-	inline iterator& operator=(const iterator& rhs)
-	{
-		this->ref = rhs.ref;
-	}
+	inline bool operator==(const iterator& rhs) const
+		{ return ref == rhs.ref; }
+	inline bool operator!=(const iterator& rhs) const
+		{ return ref != rhs.ref; }
 
-	inline iterator& operator++() 
+	inline iterator& operator++()
 	{
 		ref = ref->next;
 		return *this;
@@ -265,11 +367,13 @@ public:
 		return tmp;
 	}
 
+	template<bool D = Doubly, class = typename std::enable_if<D>::type>
 	inline iterator& operator--()
 	{
 		ref = ref->prev;
 		return *this;
 	}
+	template<bool D = Doubly, class = typename std::enable_if<D>::type>
 	inline iterator operator--(int)
 	{
 		iterator tmp(*this);
@@ -277,275 +381,656 @@ public:
 		return tmp;
 	}
 
-	inline slist<T>::iterator::reference operator*() const
+	inline reference operator*() const
+		{ return static_cast<Node*>(ref->next)->data; }
+	inline pointer operator->() const
+		{ return &static_cast<Node*>(ref->next)->data; }
+
+private:
+	Link* ref;
+};
+
+// Read-only window onto [first, last) of a list. Nothing is copied; the
+// view is valid for as long as the nodes it spans are.
+template<class T, class Alloc, bool Doubly>
+class slist<T, Alloc, Doubly>::view
+{
+public:
+	typedef typename slist<T, Alloc, Doubly>::const_iterator const_iterator;
+	typedef const_iterator iterator;
+	typedef typename slist<T, Alloc, Doubly>::size_type size_type;
+
+	view(const const_iterator& _first, const const_iterator& _last):
+		first(_first), last(_last) {}
+
+	inline const_iterator begin() const { return first; }
+	inline const_iterator end() const { return last; }
+
+	inline bool empty() const { return first == last; }
+
+	// number of elements in the window; walks the range
+	size_type size() const
 	{
-		return ref->next->data;
+		size_type n = 0;
+		for(const_iterator it = first; it != last; ++it) ++n;
+		return n;
 	}
-	inline slist<T>::iterator::pointer operator->() const
-	{
-		return ref->next;
-	}	
 
-	~iterator() {}
+	// deep copy of the window into a list of its own
+	slist<T, Alloc, Doubly> to_list() const
+		{ return slist<T, Alloc, Doubly>(first, last); }
+
 private:
-	Node* ref;
+	const_iterator first;
+	const_iterator last;
 };
 
-template<class T>
-inline bool operator==(const slist<T>& lhs, const slist<T>& rhs)
+// lists of different lengths never walk; equal ones stop at the first mismatch
+template<class T, class Alloc, bool Doubly>
+inline bool operator==(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+{
+	if(lhs.size() != rhs.size()) return false;
+
+	typename slist<T, Alloc, Doubly>::const_iterator lhs_it = lhs.begin();
+	typename slist<T, Alloc, Doubly>::const_iterator rhs_it = rhs.begin();
+
+	for(; lhs_it != lhs.end(); ++lhs_it, ++rhs_it)
+		if(!((*lhs_it) == (*rhs_it))) return false;
+
+	return true;
+}
+
+template<class T, class Alloc, bool Doubly>
+inline bool operator!=(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+	{ return !(lhs == rhs); }
+
+template<class T, class Alloc, bool Doubly>
+inline bool operator<(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+	{ return lhs.compare(rhs) < 0; }
+
+template<class T, class Alloc, bool Doubly>
+inline bool operator<=(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+	{ return lhs.compare(rhs) <= 0; }
+
+template<class T, class Alloc, bool Doubly>
+inline bool operator>(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+	{ return lhs.compare(rhs) > 0; }
+
+template<class T, class Alloc, bool Doubly>
+inline bool operator>=(const slist<T, Alloc, Doubly>& lhs, const slist<T, Alloc, Doubly>& rhs)
+	{ return lhs.compare(rhs) >= 0; }
+
+namespace std
+{
+	template<class T, class Alloc, bool Doubly>
+	struct hash<slist<T, Alloc, Doubly>>
+	{
+		std::size_t operator()(const slist<T, Alloc, Doubly>& s_l) const
+			{ return s_l.hash(); }
+	};
+}
+
+template<class T, class Alloc, bool Doubly>
+inline std::ostream& operator<<(std::ostream& os, const slist<T, Alloc, Doubly>& s_l)
+	{ return format_stream(os, s_l.cbegin(), s_l.cend()); }
+
+// Constructor
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>::slist():
+	head(), tail(&head), count(0), alloc()
+	{ reset(); }
+
+// allocator constructor; lists built from one pool can splice into each other
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>::slist(const Alloc& a):
+	head(), tail(&head), count(0), alloc(a)
+	{ reset(); }
+
+// range constructor
+template<class T, class Alloc, bool Doubly>
+template<class InputIt, class>
+slist<T, Alloc, Doubly>::slist(InputIt first, InputIt last, const Alloc& a):
+	head(), tail(&head), count(0), alloc(a)
 {
-	if(lhs.size() != rhs.size()) return 0;
+	reset();
+	insert(cbegin(), first, last);
+}
 
-	slist<int>::const_iterator lhs_it = lhs.begin();
-	slist<int>::const_iterator rhs_it = rhs.begin();
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>::slist(std::initializer_list<T> values, const Alloc& a):
+	head(), tail(&head), count(0), alloc(a)
+{
+	reset();
+	insert(cbegin(), values.begin(), values.end());
+}
 
-	while((lhs_it != lhs.end()) && (rhs_it != rhs.end()))
+// copy constructor
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>::slist(const slist<T, Alloc, Doubly>& other):
+	head(), tail(&head), count(0),
+	alloc(node_traits::select_on_container_copy_construction(other.alloc))
+{
+	reset();
+	// one allocation and one linking pass for every node
+	insert(cbegin(), other.cbegin(), other.cend());
+}
+
+// move constructor
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>::slist(slist<T, Alloc, Doubly>&& other) noexcept:
+	head(), tail(&head), count(0), alloc(std::move(other.alloc))
+{
+	reset();
+	steal(other);
+}
+
+// copy assignment
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>& slist<T, Alloc, Doubly>::operator=(const slist<T, Alloc, Doubly>& other)
+{
+	if(this == &other) return *this;
+
+	if constexpr(node_traits::propagate_on_container_copy_assignment::value)
 	{
-		if((*lhs_it) != (*rhs_it)) return false;
-		lhs_it++;
-		rhs_it++;
+		// nodes from the old allocator cannot outlive it
+		if(alloc != other.alloc)
+		{
+			clear();
+			alloc = other.alloc;
+		}
 	}
 
-	return true;
+	// overwrite the nodes already here, so equal sizes never allocate;
+	// then drop the surplus or append the rest in one block
+	Link* p = &head;
+	const_iterator src = other.cbegin(), last = other.cend();
+	for(; p != tail && src != last; ++src)
+	{
+		p = p->next;
+		static_cast<Node*>(p)->data = *src;
+	}
+	if(src == last)
+		erase(iterator(p), end());
+	else
+		insert(const_iterator(p), src, last);
+	return *this;
 }
 
-template<class T>
-inline bool operator!=(const slist<T>& lhs, const slist<T>& rhs)
+// move assignment
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly>& slist<T, Alloc, Doubly>::operator=(slist<T, Alloc, Doubly>&& other)
 {
-	if(lhs.size() != rhs.size()) return true;
+	if(this == &other) return *this;
 
-	slist<int>::const_iterator lhs_it = lhs.begin();
-	slist<int>::const_iterator rhs_it = rhs.begin();
+	clear();
+	if constexpr(node_traits::propagate_on_container_move_assignment::value)
+	{
+		alloc = std::move(other.alloc);
+		steal(other);
+	}
+	else
+	{
+		if(alloc == other.alloc)
+		{
+			steal(other);
+		}
+		else
+		{
+			// storage cannot change hands, so move element by element
+			for(iterator it = other.begin(); it != other.end(); ++it)
+				emplace_back(std::move(*it));
+			other.clear();
+		}
+	}
+	return *this;
+}
 
-	while((lhs_it != lhs.end()) && (rhs_it != rhs.end()))
+// Destructor
+template<class T, class Alloc, bool Doubly>
+inline slist<T, Alloc, Doubly>::~slist()
+	{ clear(); }
+
+// steal(other)				//relinks other's chain behind this sentinel in O(1)
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::steal(slist<T, Alloc, Doubly>& other) noexcept
+{
+	if(other.empty()) return;
+
+	head.next = other.head.next;
+	set_prev(head.next, &head);
+	tail = other.tail;
+	tail->next = &head;
+	set_prev(&head, tail);
+	count = other.count;
+
+	other.reset();
+}
+
+// set_prev(link, prev)		//stores a back link when the layout has one
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::set_prev(Link* l, Link* prev)
+{
+	if constexpr(Doubly)
+		l->prev = prev;
+}
+
+// relink_prev()			//rebuilds every back link in one forward pass
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::relink_prev()
+{
+	if constexpr(Doubly)
+	{
+		Link* p = &head;
+		do
+		{
+			p->next->prev = p;
+			p = p->next;
+		} while(p != &head);
+	}
+}
+
+// reset()					//empties the ring without touching any nodes
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::reset() noexcept
+{
+	head.next = &head;
+	set_prev(&head, &head);
+	tail = &head;
+	count = 0;
+}
+
+// create_node(next, args...)	//builds a node in storage from the list's allocator
+template<class T, class Alloc, bool Doubly>
+template<class... Args>
+inline typename slist<T, Alloc, Doubly>::Node* slist<T, Alloc, Doubly>::create_node(Link* next, Args&&... args)
+{
+	Node* n = node_traits::allocate(alloc, 1);
+	try
 	{
-		if((*lhs_it) != (*rhs_it)) return true;
-		lhs_it++;
-		rhs_it++;
+		node_traits::construct(alloc, n, next, std::forward<Args>(args)...);
 	}
+	catch(...)
+	{
+		node_traits::deallocate(alloc, n, 1);
+		throw;
+	}
+	return n;
+}
 
-	return false;
+// destroy_node(node)		//destroys a node and hands its storage back to the allocator
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::destroy_node(Link* l)
+{
+	Node* n = static_cast<Node*>(l);
+	node_traits::destroy(alloc, n);
+	node_traits::deallocate(alloc, n, 1);
 }
 
-template<class T>
-inline std::ostream& operator<<(std::ostream& os, const slist<T>& s_l)
+// link_after(pos, node)	//splices a new node in after pos and updates tail/count
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::link_after(Link* pos, Node* n)
 {
-	os << (s_l.to_string());
-	return os;
+	if(pos == tail) tail = n;
+	set_prev(n, pos);
+	set_prev(n->next, n);
+	pos->next = n;
+	++count;
 }
 
-// Constructor
-template<class T>
-slist<T>::slist():
-	tail(new Node(T()))
+// make_chain(first, last, chain_tail, n)	//builds unlinked nodes for a range, in order
+template<class T, class Alloc, bool Doubly>
+template<class InputIt>
+typename slist<T, Alloc, Doubly>::Link* slist<T, Alloc, Doubly>::make_chain(InputIt first, InputIt last, Link*& chain_tail, size_type& n)
 {
-	tail->next = tail;
-	tail->prev = tail;
+	typedef typename std::iterator_traits<InputIt>::iterator_category category;
+
+	n = 0;
+	chain_tail = nullptr;
+	if constexpr(frees_singly<node_allocator>::value && std::is_base_of<std::forward_iterator_tag, category>::value)
+	{
+		// one block for the whole range; erase later frees the nodes singly
+		size_type len = std::distance(first, last);
+		if(len == 0) return nullptr;
+
+		Node* block = node_traits::allocate(alloc, len);
+		try
+		{
+			for(; n < len; ++n, ++first)
+			{
+				node_traits::construct(alloc, block + n, nullptr, *first);
+				if(n > 0)
+				{
+					block[n - 1].next = block + n;
+					set_prev(block + n, block + n - 1);
+				}
+			}
+		}
+		catch(...)
+		{
+			for(size_type i = 0; i < n; ++i) node_traits::destroy(alloc, block + i);
+			node_traits::deallocate(alloc, block, len);
+			throw;
+		}
+		chain_tail = block + len - 1;
+		return block;
+	}
+	else
+	{
+		Link* chain = nullptr;
+		try
+		{
+			for(; first != last; ++first, ++n)
+			{
+				Node* x = create_node(nullptr, *first);
+				if(chain_tail != nullptr)
+				{
+					chain_tail->next = x;
+					set_prev(x, chain_tail);
+				}
+				else
+				{
+					chain = x;
+				}
+				chain_tail = x;
+			}
+		}
+		catch(...)
+		{
+			destroy_chain(chain);
+			throw;
+		}
+		return chain;
+	}
 }
 
-// copy constructor
-template<class T>
-slist<T>::slist(const slist<T>& other):
-	tail(new Node(T()))
+// link_chain_after(pos, chain, chain_tail, n)	//splices a built chain in after pos and updates tail/count
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::link_chain_after(Link* pos, Link* chain, Link* chain_tail, size_type n)
 {
-	tail->next = tail;
-	tail->prev = tail;
+	if(chain == nullptr) return;
+	if(pos == tail) tail = chain_tail;
+	chain_tail->next = pos->next;
+	set_prev(pos->next, chain_tail);
+	set_prev(chain, pos);
+	pos->next = chain;
+	count += n;
+}
 
-	for(slist<T>::const_iterator it = other.begin();
-		it != other.end();
-		it++)
+// destroy_chain(chain)		//destroys the nodes of an unlinked chain
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::destroy_chain(Link* chain)
+{
+	while(chain != nullptr)
 	{
-		this->push_back(*it);
+		Link* next = chain->next;
+		destroy_node(chain);
+		chain = next;
 	}
 }
-// Destructor
-template<class T>
-inline slist<T>::~slist()
+
+// insert(index, first, last)	//inserts a range before the specified index in one pass.
+template<class T, class Alloc, bool Doubly>
+template<class InputIt, class>
+void slist<T, Alloc, Doubly>::insert(const const_iterator& pos, InputIt first, InputIt last)
 {
+	Link* chain_tail;
+	size_type n;
+	Link* chain = make_chain(first, last, chain_tail, n);
+	link_chain_after(const_cast<Link*>(pos.ref), chain, chain_tail, n);
+}
+
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::insert(const const_iterator& pos, std::initializer_list<T> values)
+	{ insert(pos, values.begin(), values.end()); }
+
+// assign(first, last)		//replaces the contents with a range; the list is unchanged if building it throws.
+template<class T, class Alloc, bool Doubly>
+template<class InputIt, class>
+void slist<T, Alloc, Doubly>::assign(InputIt first, InputIt last)
+{
+	// build before clearing, so the range may come from this list
+	Link* chain_tail;
+	size_type n;
+	Link* chain = make_chain(first, last, chain_tail, n);
 	clear();
-	delete tail;
+	link_chain_after(&head, chain, chain_tail, n);
 }
 
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::assign(std::initializer_list<T> values)
+	{ assign(values.begin(), values.end()); }
+
 // push_back(value)			//adds a new value to the end of this list.
-template<class T>
-inline void slist<T>::push_back(const T& data)
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::push_back(const T& data)
 	{ insert(end(), data); }
 
-template<class T>
-inline void slist<T>::push_back(T&& data)
-	{ insert(end(), data); }
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::push_back(T&& data)
+	{ insert(end(), std::move(data)); }
 
 // pop_back() 				//erase value at end of list
-template<class T>
-inline void slist<T>::pop_back()
-	{ erase(end()); }
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::pop_back()
+{
+	if(empty()) return;
+
+	// the compact layout has to find the link before tail the long way
+	Link* p;
+	if constexpr(Doubly)
+	{
+		p = tail->prev;
+	}
+	else
+	{
+		p = &head;
+		while(p->next != tail) p = p->next;
+	}
+	erase(iterator(p));
+}
 
 // push_front(value)		//adds a new value to the start of this list
-template<class T>
-inline void slist<T>::push_front(const T& data)
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::push_front(const T& data)
 	{ insert(begin(), data); }
 
-template<class T>
-inline void slist<T>::push_front(T&& data)
-	{ insert(begin(), data); }
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::push_front(T&& data)
+	{ insert(begin(), std::move(data)); }
 
 // pop_front()				//erase value at front of list
-template<class T>
-inline void slist<T>::pop_front()
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::pop_front()
 	{ erase(begin()); }
 
+// emplace_front(args...)	//constructs a new value in place at the start of this list
+template<class T, class Alloc, bool Doubly>
+template<class... Args>
+inline typename slist<T, Alloc, Doubly>::reference slist<T, Alloc, Doubly>::emplace_front(Args&&... args)
+	{ return *emplace(cbegin(), std::forward<Args>(args)...); }
+
+// emplace_back(args...)	//constructs a new value in place at the end of this list
+template<class T, class Alloc, bool Doubly>
+template<class... Args>
+inline typename slist<T, Alloc, Doubly>::reference slist<T, Alloc, Doubly>::emplace_back(Args&&... args)
+	{ return *emplace(cend(), std::forward<Args>(args)...); }
+
+// emplace(index, args...)	//constructs a new value in place before the specified index.
+template<class T, class Alloc, bool Doubly>
+template<class... Args>
+inline typename slist<T, Alloc, Doubly>::iterator slist<T, Alloc, Doubly>::emplace(const const_iterator& pos, Args&&... args)
+{
+	Link* p = const_cast<Link*>(pos.ref);
+	link_after(p, create_node(p->next, std::forward<Args>(args)...));
+	return iterator(p);
+}
+
 // clear()					//erases all elements from this list.
-template<class T>
-inline void slist<T>::clear()
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::clear()
 {
-	while(!empty())
+	if constexpr(is_releasable<node_allocator>::value)
 	{
-		pop_front();
+		// when every outstanding node is ours the pool drops its slabs at once
+		// and only non-trivial payloads need a walk
+		if(alloc.outstanding() == count)
+		{
+			if constexpr(!std::is_trivially_destructible<T>::value)
+			{
+				for(Link* n = head.next; n != &head; n = n->next)
+					node_traits::destroy(alloc, static_cast<Node*>(n));
+			}
+			alloc.release();
+		}
+		else
+		{
+			Link* n = head.next;
+			while(n != &head)
+			{
+				Link* next = n->next;
+				destroy_node(n);
+				n = next;
+			}
+		}
 	}
+	else
+	{
+		Link* n = head.next;
+		while(n != &head)
+		{
+			Link* next = n->next;
+			destroy_node(n);
+			n = next;
+		}
+	}
+
+	reset();
 }
 
 // equals(list)				//Returns true if the two lists contain the same elements in the same order.
-template<class T>
-inline bool slist<T>::equals(const slist<T>& other) const
-	{ return tail == other.tail; }
+template<class T, class Alloc, bool Doubly>
+inline bool slist<T, Alloc, Doubly>::equals(const slist<T, Alloc, Doubly>& other) const
+	{ return *this == other; }
+
+// compare(list)			//Orders two lists by their first differing element, then by length.
+template<class T, class Alloc, bool Doubly>
+inline int slist<T, Alloc, Doubly>::compare(const slist<T, Alloc, Doubly>& other) const
+	{ return compare_ranges(cbegin(), cend(), other.cbegin(), other.cend()); }
+
+// hash()					//Returns a hash of the elements in order.
+template<class T, class Alloc, bool Doubly>
+std::size_t slist<T, Alloc, Doubly>::hash() const
+{
+	sequence_hash<T> h;
+	for(const_iterator it = cbegin(); it != cend(); ++it)
+		h.add(*it);
+	return h.value();
+}
 
 //get(index)				//Returns the element at the specified index in this list.
-template<class T>
-inline typename slist<T>::const_reference slist<T>::get(const slist<T>::iterator& pos) const
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::const_reference slist<T, Alloc, Doubly>::get(const slist<T, Alloc, Doubly>::iterator& pos) const
 	{ return (*pos); }
 
-template<class T>
-inline typename slist<T>::const_reference slist<T>::get(const slist<T>::const_iterator& pos) const
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::const_reference slist<T, Alloc, Doubly>::get(const slist<T, Alloc, Doubly>::const_iterator& pos) const
 	{ return (*pos); }
 
-template<class T>
-inline const std::vector<typename slist<T>::const_reference>& slist<T>::get(slist<T>::iterator& lhs, const slist<T>::iterator& rhs) const
-{
-	std::vector<typename slist<T>::const_reference> rvec = new std::vector<typename slist<T>::const_reference>();
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::view slist<T, Alloc, Doubly>::get(const const_iterator& lhs, const const_iterator& rhs) const
+	{ return view(lhs, rhs); }
 
-	while(lhs != rhs)
-	{
-		rvec.push_back(*lhs);
-		lhs++;
-	}
-
-	return *rvec;
-	
-}
-
-template<class T>
-inline const std::vector<typename slist<T>::const_reference>& slist<T>::get(slist<T>::const_iterator& lhs, const slist<T>::const_iterator& rhs) const
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::view slist<T, Alloc, Doubly>::get(const const_iterator& pos, size_type n) const
 {
-	std::vector<typename slist<T>::const_reference> rvec = new std::vector<typename slist<T>::const_reference>();
-	
-	while(lhs != rhs)
-	{
-		rvec.push_back(*lhs);
-		lhs++;
-	}
-
-	return *rvec;
+	const_iterator last = pos;
+	while(n-- && last != cend()) ++last;
+	return view(pos, last);
 }
 
 //begin()					//returns iterator to first element
-template<class T>
-inline typename slist<T>::iterator slist<T>::begin()
-	{ return typename slist<T>::iterator(tail->next); }
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::iterator slist<T, Alloc, Doubly>::begin()
+	{ return typename slist<T, Alloc, Doubly>::iterator(&head); }
 
-template<class T>
-inline const typename slist<T>::const_iterator slist<T>::begin() const
-	{ return typename slist<T>::const_iterator(tail->next); }
+template<class T, class Alloc, bool Doubly>
+inline const typename slist<T, Alloc, Doubly>::const_iterator slist<T, Alloc, Doubly>::begin() const
+	{ return typename slist<T, Alloc, Doubly>::const_iterator(&head); }
 
-template<class T>
-inline const typename slist<T>::const_iterator slist<T>::cbegin() const
-	{ return typename slist<T>::const_iterator(tail->next); }
+template<class T, class Alloc, bool Doubly>
+inline const typename slist<T, Alloc, Doubly>::const_iterator slist<T, Alloc, Doubly>::cbegin() const
+	{ return typename slist<T, Alloc, Doubly>::const_iterator(&head); }
 
 //end() 					//returns iterator to last element
-template<class T>
-inline typename slist<T>::iterator slist<T>::end()
-	{ return typename slist<T>::iterator(tail); }
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::iterator slist<T, Alloc, Doubly>::end()
+	{ return typename slist<T, Alloc, Doubly>::iterator(tail); }
 
-template<class T>
-inline const typename slist<T>::const_iterator slist<T>::end() const
-	{ return typename slist<T>::const_iterator(tail); }
+template<class T, class Alloc, bool Doubly>
+inline const typename slist<T, Alloc, Doubly>::const_iterator slist<T, Alloc, Doubly>::end() const
+	{ return typename slist<T, Alloc, Doubly>::const_iterator(tail); }
 
-template<class T>
-inline const typename slist<T>::const_iterator slist<T>::cend() const
-	{ return typename slist<T>::const_iterator(tail); }
+template<class T, class Alloc, bool Doubly>
+inline const typename slist<T, Alloc, Doubly>::const_iterator slist<T, Alloc, Doubly>::cend() const
+	{ return typename slist<T, Alloc, Doubly>::const_iterator(tail); }
 
 //front() 					//returns value of elemnt at front of list
-template<class T>
-inline T slist<T>::front()
+template<class T, class Alloc, bool Doubly>
+inline T slist<T, Alloc, Doubly>::front()
+	{ return *begin(); }
+template<class T, class Alloc, bool Doubly>
+inline const T slist<T, Alloc, Doubly>::front() const
 	{ return *begin(); }
-template<class T>
-inline const T slist<T>::front() const
-	{ return *begin(); } 
 
 //bacK()					//returns value of element at end of list
-template<class T>
-inline T slist<T>::back()
-	{ return *end(); }
-template<class T>
-inline const T slist<T>::back() const
-	{ return *end(); }
+template<class T, class Alloc, bool Doubly>
+inline T slist<T, Alloc, Doubly>::back()
+	{ return static_cast<Node*>(tail)->data; }
+template<class T, class Alloc, bool Doubly>
+inline const T slist<T, Alloc, Doubly>::back() const
+	{ return static_cast<const Node*>(tail)->data; }
 
 //insert(value, index)		//Inserts the element into this list before the specified index.
-template<class T>
-inline void slist<T>::insert(const typename slist<T>::iterator& pos, const T& data)
-{
-	Node* n = new Node(data, pos.ref->next, pos.ref);
-	if(pos.ref == tail) tail = n;
-	pos.ref->next = n;
-}
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::insert(const typename slist<T, Alloc, Doubly>::iterator& pos, const T& data)
+	{ emplace(pos, data); }
 
-template<class T>
-inline void slist<T>::insert(const typename slist<T>::iterator& pos, T&& data)
-{
-	Node* n = new Node(data, pos.ref->next, pos.ref);
-	if(pos.ref == tail) tail = n;
-	pos.ref->next = n;
-}
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::insert(const typename slist<T, Alloc, Doubly>::iterator& pos, T&& data)
+	{ emplace(pos, std::move(data)); }
 
-template<class T>
-inline void slist<T>::insert(const typename slist<T>::const_iterator& pos, const T& data)
-{
-	const Node* n = new Node(data, pos.ref->next, pos.ref);
-	if(pos.ref == tail) tail = n;
-	pos.ref->next = n;
-}
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::insert(const typename slist<T, Alloc, Doubly>::const_iterator& pos, const T& data)
+	{ emplace(pos, data); }
 
-template<class T>
-inline void slist<T>::insert(const typename slist<T>::const_iterator& pos, T&& data)
-{
-	const Node* n = new Node(data, pos.ref->next, pos.ref);
-	if(pos.ref == tail) tail = n;
-	pos.ref->next = n;
-}
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::insert(const typename slist<T, Alloc, Doubly>::const_iterator& pos, T&& data)
+	{ emplace(pos, std::move(data)); }
 
 //swap(index1, index2)		//Switches the payload data of specified indexex.
-template<class T>
-inline void slist<T>::swap(slist<T>::iterator& lhs, slist<T>::iterator& rhs)
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::swap(slist<T, Alloc, Doubly>::iterator& lhs, slist<T, Alloc, Doubly>::iterator& rhs)
 {
-	T _data = lhs.ref->data;
-	lhs.ref->data = rhs.ref->data;
-	rhs.ref->data = _data;
+	using std::swap;
+	swap(*lhs, *rhs);
 }
 
 //reverse()					// reverse the linked circular_list (end->beginning; beginning->end)
-template<class T>
-void slist<T>::reverse() {
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::reverse() {
 	if (this->empty()) { return; }
 
-	Node* new_tail = tail->next->next;
-	Node* i = tail->next;
-	Node* p = tail;
-	Node* n;
+	Link* new_tail = head.next;
+	Link* i = &head;
+	Link* p = tail;
+	Link* n;
 
 	// 	avoid out of bounds by doing one cycle before\
 		terminal condition check
 	do {
 		n = i->next;
 		i->next = p;
+		set_prev(i, n);
 		p = i;
 		i = n;
 	} while (p != tail);
@@ -554,260 +1039,346 @@ void slist<T>::reverse() {
 }
 
 //rotate(index)				//rotates specified index to front
-template<class T>
-void slist<T>::rotate(typename slist<T>::iterator it)
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::rotate(typename slist<T, Alloc, Doubly>::iterator it)
 {
-	if (it == end()) return;
-	Node* sent = tail->next;
-	tail->next = tail->next->next;
+	if (it == begin() || it == end()) return;
+	Link* sent = &head;
+	tail->next = head.next;
+	set_prev(tail->next, tail);
 	sent->next = it.ref->next;
+	set_prev(sent->next, sent);
 	it.ref->next = sent;
+	set_prev(sent, it.ref);
 	tail = it.ref;
 }
 
-template<class T>
-void slist<T>::rotate(typename slist<T>::const_iterator it)
-{
-	if (it == cend()) return;
-	Node* sent = tail->next;
-	tail->next = tail->next->next;
-	sent->next = it.ref->next;
-	it.ref->next = sent;
-	tail = it.ref;
-}
-
-// empty()					//Returns true if this list contains no elements.
-template<class T>
-inline bool slist<T>::empty() const
-	{ return tail == tail->next; }
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::rotate(typename slist<T, Alloc, Doubly>::const_iterator it)
+	{ rotate(iterator(const_cast<Link*>(it.ref))); }
 
-// erase(index)				//erases the element at the specified index from this list.
-template<class T>
-void slist<T>::erase(slist<T>::iterator pos)
+// splice_after(index, list)	//Moves every element of list in before the specified index.
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::splice_after(const const_iterator& pos, slist<T, Alloc, Doubly>& other)
 {
-	if(pos == this->end())
+	if(&other == this || other.empty()) return;
+
+	Link* p = const_cast<Link*>(pos.ref);
+	if(!(alloc == other.alloc))
 	{
-		 pop_back();
-		 return;
+		// nodes cannot change allocator, so move the payloads across instead
+		for(iterator it = other.begin(); it != other.end(); ++it)
+		{
+			emplace(const_iterator(p), std::move(*it));
+			p = p->next;
+		}
+		other.clear();
+		return;
 	}
-	if(pos.ref->next == tail) tail = pos.ref;
-	Node* n = pos.ref->next;
-	pos.ref->next = pos.ref->next->next;
-	delete n;
+
+	other.tail->next = p->next;
+	set_prev(p->next, other.tail);
+	p->next = other.head.next;
+	set_prev(p->next, p);
+	if(p == tail) tail = other.tail;
+	count += other.count;
+
+	other.reset();
 }
 
-template<class T>
-void slist<T>::erase(slist<T>::const_iterator pos)
+// splice_after(index, list, first, last)	//Moves [first, last) of list in before the specified index.
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::splice_after(const const_iterator& pos, slist<T, Alloc, Doubly>& other,
+	const const_iterator& first, const const_iterator& last)
 {
-	if(pos == this->end())
+	if(first == last) return;
+
+	Link* p = const_cast<Link*>(pos.ref);
+	Link* before = const_cast<Link*>(first.ref);
+	Link* a = before->next;
+	Link* b = const_cast<Link*>(last.ref);
+
+	if(!(alloc == other.alloc))
 	{
-		 pop_back();
-		 return;
+		for(iterator it(before); it != iterator(b); ++it)
+		{
+			emplace(const_iterator(p), std::move(*it));
+			p = p->next;
+		}
+		other.erase(first, last);
+		return;
 	}
-	if(pos.ref->next == tail) tail = pos.ref;
-	Node* n = pos.ref->next;
-	pos.ref->next = pos.ref->next->next;
-	delete n;
-}
 
-template<class T>
-inline void slist<T>::erase(slist<T>::iterator lhs, slist<T>::iterator rhs)
-{
-	while(lhs->next != rhs)
+	// size bookkeeping is the only part that depends on the length of the range
+	if(&other != this)
 	{
-		typename slist<T>::iterator tmp(*lhs);
-		lhs++;
-		erase(tmp);
+		size_type n = 1;
+		for(Link* l = a; l != b; l = l->next) ++n;
+		other.count -= n;
+		count += n;
 	}
+
+	before->next = b->next;
+	set_prev(before->next, before);
+	if(other.tail == b) other.tail = before;
+	b->next = p->next;
+	set_prev(b->next, b);
+	p->next = a;
+	set_prev(a, p);
+	if(p == tail) tail = b;
 }
 
-template<class T>
-inline void slist<T>::erase(slist<T>::const_iterator lhs, slist<T>::const_iterator rhs)
+// merge(list)				//Merges sorted list into this sorted list, leaving list empty.
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::merge(slist<T, Alloc, Doubly>& other)
+	{ merge(other, std::less<T>()); }
+
+template<class T, class Alloc, bool Doubly>
+template<class Compare>
+void slist<T, Alloc, Doubly>::merge(slist<T, Alloc, Doubly>& other, Compare comp)
 {
-	while(lhs->next != rhs)
+	if(&other == this || other.empty()) return;
+
+	if(!(alloc == other.alloc))
 	{
-		typename slist<T>::iterator tmp(*lhs);
-		lhs++;
-		erase(tmp);
+		slist<T, Alloc, Doubly> tmp{Alloc(alloc)};
+		tmp.splice_after(tmp.cbegin(), other);
+		merge(tmp, comp);
+		return;
 	}
-}
 
-// set(index, value)		//Replaces the element at the specified index in this list with a new value.
-template<class T>
-inline void slist<T>::set(typename slist<T>::iterator& pos, const T& _data)
-	{ pos.ref->next->data = _data; }
-
-template<class T>
-inline void slist<T>::set(typename slist<T>::iterator& pos, T&& _data)
-	{ pos.ref->next->data = _data; }
-
-template<class T>
-inline void slist<T>::set(typename slist<T>::const_iterator& pos, const T& _data)
-	{ pos.ref->next->data = _data; }
-
-template<class T>
-inline void slist<T>::set(typename slist<T>::const_iterator& pos, T&& _data)
-	{ pos.ref->next->data = _data; }
-
-template<class T>
-void slist<T>::set(
-	typename slist<T>::iterator& lhs,
-	typename slist<T>::iterator& rhs,
-	const T& data)
-{
-	while(lhs->next != rhs)
+	Link* p = &head;
+	Link* b = other.head.next;
+	while(b != &other.head)
 	{
-		typename slist<T>::iterator tmp(lhs);
-		lhs++;
-		set(tmp, data);
+		if(p->next == &head)
+		{
+			// this list ran out; the rest of other goes on the end as is
+			p->next = b;
+			other.tail->next = &head;
+			tail = other.tail;
+			break;
+		}
+		if(comp(static_cast<Node*>(b)->data, static_cast<Node*>(p->next)->data))
+		{
+			Link* nb = b->next;
+			b->next = p->next;
+			p->next = b;
+			p = b;
+			b = nb;
+		}
+		else
+		{
+			p = p->next;
+		}
 	}
+	count += other.count;
+	other.reset();
+	relink_prev();
 }
 
-template<class T>
-void slist<T>::set(
-	typename slist<T>::iterator& lhs,
-	typename slist<T>::iterator& rhs,
-	T&& data)
+// merge_chains(lhs, rhs)	//merges two sorted null terminated chains, returns the new first link
+template<class T, class Alloc, bool Doubly>
+template<class Compare>
+typename slist<T, Alloc, Doubly>::Link* slist<T, Alloc, Doubly>::merge_chains(Link* lhs, Link* rhs, Compare& comp)
 {
-	while(lhs != rhs)
-	{
-		typename slist<T>::iterator tmp(lhs);
-		lhs++;
-		set(tmp, data);
-	}	
-}
+	Link front;
+	Link* t = &front;
 
-template<class T>
-void slist<T>::set(
-	typename slist<T>::const_iterator& lhs,
-	typename slist<T>::const_iterator& rhs,
-	const T& data)
-{
-	while(lhs != rhs)
+	while(lhs != nullptr && rhs != nullptr)
 	{
-		typename slist<T>::iterator tmp(lhs);
-		lhs++;
-		set(tmp, data);
+		if(comp(static_cast<Node*>(rhs)->data, static_cast<Node*>(lhs)->data))
+		{
+			t->next = rhs;
+			rhs = rhs->next;
+		}
+		else
+		{
+			t->next = lhs;
+			lhs = lhs->next;
+		}
+		t = t->next;
 	}
-}
+	t->next = (lhs != nullptr) ? lhs : rhs;
 
-template<class T>
-void slist<T>::set(
-	typename slist<T>::const_iterator& lhs,
-	typename slist<T>::const_iterator& rhs,
-	T&& data)
-{
-	while(lhs != rhs)
-	{
-		typename slist<T>::iterator tmp(lhs);
-		lhs++;
-		set(tmp, data);
-	}
+	return front.next;
 }
-// size()					//Returns the number of elements in this list.
-template<class T>
-typename slist<T>::size_type slist<T>::size() const
+
+// sort()					//Sorts the list in O(n log n) by relinking nodes.
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::sort()
+	{ sort(std::less<T>()); }
+
+template<class T, class Alloc, bool Doubly>
+template<class Compare>
+void slist<T, Alloc, Doubly>::sort(Compare comp)
 {
-	typename slist<T>::const_iterator it = begin();
-	typename slist<T>::size_type count = 0;
-	while(it != end())
+	if(count < 2) return;
+
+	// bottom-up merge sort: bin[i] holds a sorted run of 2^i nodes, so 64
+	// bins cover any list that fits in memory and nothing is allocated
+	Link* bin[64] = {};
+	std::size_t bins = 0;
+
+	tail->next = nullptr;
+	Link* n = head.next;
+	while(n != nullptr)
 	{
-		count++;
-		it++;
+		Link* carry = n;
+		n = n->next;
+		carry->next = nullptr;
+
+		std::size_t i = 0;
+		for(; i < bins && bin[i] != nullptr; ++i)
+		{
+			carry = merge_chains(bin[i], carry, comp);
+			bin[i] = nullptr;
+		}
+		bin[i] = carry;
+		if(i == bins) ++bins;
 	}
-	return count;
-}
-
-// subList(start, length)	//Returns a new list containing elements from a sub-range of this list.
-template<class T>
-slist<T>& slist<T>::sub_list(slist<T>::iterator& pos, slist<T>::size_type count)
-{
-	slist<T> *n_list = new slist<T>();
 
-	do
+	// higher bins hold earlier elements, so they go on the left to stay stable
+	Link* sorted = nullptr;
+	for(std::size_t i = 0; i < bins; ++i)
 	{
-		n_list->push_back(*pos);
-		pos++;
-	} while(count--);
+		if(bin[i] != nullptr)
+			sorted = (sorted == nullptr) ? bin[i] : merge_chains(bin[i], sorted, comp);
+	}
 
-	return *n_list;
+	head.next = sorted;
+	Link* last = sorted;
+	while(last->next != nullptr) last = last->next;
+	last->next = &head;
+	tail = last;
+	relink_prev();
 }
 
-template<class T>
-slist<T>& slist<T>::sub_list(slist<T>::const_iterator& pos, slist<T>::size_type count)
-{
-	slist<T> *n_list = new slist<T>();
+// empty()					//Returns true if this list contains no elements.
+template<class T, class Alloc, bool Doubly>
+inline bool slist<T, Alloc, Doubly>::empty() const
+	{ return count == 0; }
 
-	do
+// erase(index)				//erases the element at the specified index from this list.
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::erase(slist<T, Alloc, Doubly>::iterator pos)
+{
+	if(pos == this->end())
 	{
-		n_list->push_back(*pos);
-		pos++;
-	} while(count--);
-
-	return *n_list;
+		 pop_back();
+		 return;
+	}
+	if(pos.ref->next == tail) tail = pos.ref;
+	Link* n = pos.ref->next;
+	pos.ref->next = pos.ref->next->next;
+	set_prev(pos.ref->next, pos.ref);
+	destroy_node(n);
+	--count;
 }
 
-template<class T>
-slist<T>& slist<T>::sub_list(slist<T>::iterator& lhs, slist<T>::iterator& rhs)
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::erase(slist<T, Alloc, Doubly>::const_iterator pos)
+	{ erase(iterator(const_cast<Link*>(pos.ref))); }
+
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::erase(slist<T, Alloc, Doubly>::iterator lhs, slist<T, Alloc, Doubly>::iterator rhs)
 {
-	slist<T> *n_list = new slist<T>();
+	if(lhs == rhs) return;
 
-	while(lhs != rhs)
+	// [lhs, rhs) covers the nodes after lhs.ref up to and including rhs.ref
+	Link* stop = rhs.ref->next;
+	Link* n = lhs.ref->next;
+	while(n != stop)
 	{
-		n_list->push_back(*lhs);
-		lhs++;
+		Link* next = n->next;
+		destroy_node(n);
+		--count;
+		n = next;
 	}
-
-	return *n_list;
+	lhs.ref->next = stop;
+	set_prev(stop, lhs.ref);
+	if(rhs.ref == tail) tail = lhs.ref;
 }
 
-template<class T>
-slist<T>& slist<T>::sub_list(slist<T>::const_iterator& lhs, slist<T>::const_iterator& rhs)
-{
-	slist<T> *n_list = new slist<T>();
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::erase(slist<T, Alloc, Doubly>::const_iterator lhs, slist<T, Alloc, Doubly>::const_iterator rhs)
+	{ erase(iterator(const_cast<Link*>(lhs.ref)), iterator(const_cast<Link*>(rhs.ref))); }
 
+// set(index, value)		//Replaces the element at the specified index in this list with a new value.
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::set(typename slist<T, Alloc, Doubly>::iterator& pos, const T& _data)
+	{ *pos = _data; }
+
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::set(typename slist<T, Alloc, Doubly>::iterator& pos, T&& _data)
+	{ *pos = std::move(_data); }
+
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::set(typename slist<T, Alloc, Doubly>::const_iterator& pos, const T& _data)
+	{ static_cast<Node*>(const_cast<Link*>(pos.ref->next))->data = _data; }
+
+template<class T, class Alloc, bool Doubly>
+inline void slist<T, Alloc, Doubly>::set(typename slist<T, Alloc, Doubly>::const_iterator& pos, T&& _data)
+	{ static_cast<Node*>(const_cast<Link*>(pos.ref->next))->data = std::move(_data); }
+
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::set(
+	typename slist<T, Alloc, Doubly>::iterator& lhs,
+	typename slist<T, Alloc, Doubly>::iterator& rhs,
+	const T& data)
+{
 	while(lhs != rhs)
 	{
-		n_list->push_back(*lhs);
+		set(lhs, data);
 		lhs++;
 	}
-
-	return *n_list;
 }
 
-// toString()				//Converts the list to a printable string representation.
-template<class T>
-std::string slist<T>::to_string()
+template<class T, class Alloc, bool Doubly>
+void slist<T, Alloc, Doubly>::set(
+	typename slist<T, Alloc, Doubly>::const_iterator& lhs,
+	typename slist<T, Alloc, Doubly>::const_iterator& rhs,
+	const T& data)
 {
-	std::stringstream ss;
-
-	int count = 0;
-
-	for(slist<T>::iterator it = begin();
-		it != end();
-		++it)
+	while(lhs != rhs)
 	{
-		ss << (*it) << ' ';
+		set(lhs, data);
+		lhs++;
 	}
-
-	return ss.str();
 }
 
-template<class T>
-std::string slist<T>::to_string() const
-{
-	std::stringstream ss;
-
-	int count = 0;
+// size()					//Returns the number of elements in this list.
+template<class T, class Alloc, bool Doubly>
+inline typename slist<T, Alloc, Doubly>::size_type slist<T, Alloc, Doubly>::size() const
+	{ return count; }
 
-	for(slist<T>::const_iterator it = begin();
-		it != end();
-		++it)
-	{
-		ss << (*it) << ' ';
-	}
+// subList(start, length)	//Returns a new list containing elements from a sub-range of this list.
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly> slist<T, Alloc, Doubly>::sub_list(const const_iterator& pos, size_type n) const
+	{ return get(pos, n).to_list(); }
 
-	return ss.str();
-}
+template<class T, class Alloc, bool Doubly>
+slist<T, Alloc, Doubly> slist<T, Alloc, Doubly>::sub_list(const const_iterator& lhs, const const_iterator& rhs) const
+	{ return view(lhs, rhs).to_list(); }
 
-#endif
\ No newline at end of file
+// toString()				//Converts the list to a printable string representation.
+template<class T, class Alloc, bool Doubly>
+std::string slist<T, Alloc, Doubly>::to_string()
+	{ return format_string(cbegin(), cend()); }
+
+template<class T, class Alloc, bool Doubly>
+std::string slist<T, Alloc, Doubly>::to_string() const
+	{ return format_string(cbegin(), cend()); }
+
+// format_to(out)			//Writes the list as to_string would, without building the string.
+template<class T, class Alloc, bool Doubly>
+template<class OutputIt>
+OutputIt slist<T, Alloc, Doubly>::format_to(OutputIt out) const
+	{ return format_range(cbegin(), cend(), out); }
+
+// format_to(buf, n)		//Writes the list into a caller's buffer; returns the length needed.
+template<class T, class Alloc, bool Doubly>
+typename slist<T, Alloc, Doubly>::size_type slist<T, Alloc, Doubly>::format_to(char* buf, size_type n) const
+	{ return format_range(cbegin(), cend(), buf, n); }
+
+#endif
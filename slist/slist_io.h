@@ -0,0 +1,92 @@
+#ifndef SLIST_IO_H
+#define SLIST_IO_H
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+#include "binary_io.h"
+#include "mapped_file.h"
+#include "slist.h"
+
+// Binary snapshots of an slist: the common header (magic "SLST") followed
+// by the elements front to back. Trivially copyable elements are stored
+// as their raw bytes, back to back, so a snapshot is one block copy each
+// way; other element types go through binary_traits.
+
+constexpr std::uint16_t slist_binary_version = 1;
+
+// save_binary(os, list)	//Writes list to os; returns false if the stream failed.
+template<class T, class Alloc, bool Doubly>
+bool save_binary(std::ostream& os, const slist<T, Alloc, Doubly>& list)
+{
+	typedef binary_traits<T> traits;
+
+	binary_writer w(os);
+	write_header(w, "SLST", slist_binary_version, traits::raw ? sizeof(T) : 0, 0, list.size());
+	for(typename slist<T, Alloc, Doubly>::const_iterator it = list.cbegin(); it != list.cend(); ++it)
+		traits::write(w, *it);
+	w.flush();
+	return w.good();
+}
+
+// save_binary(path, list)	//Writes list to a new file at path.
+template<class T, class Alloc, bool Doubly>
+bool save_binary(const char* path, const slist<T, Alloc, Doubly>& list)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	return out && save_binary(out, list) && out.flush();
+}
+
+// load_binary(first, last, list)	//Replaces list with the snapshot in [first, last); false if it is not one.
+template<class T, class Alloc, bool Doubly>
+bool load_binary(const char* first, const char* last, slist<T, Alloc, Doubly>& list)
+{
+	typedef binary_traits<T> traits;
+
+	list.clear();
+	binary_reader r(first, last);
+	binary_header h;
+	if(!read_header(r, "SLST", slist_binary_version, traits::raw ? sizeof(T) : 0, h))
+		return false;
+
+	if constexpr(traits::raw)
+	{
+		// every element is in one block; check its length once, then build
+		// the whole chain from it in one pass, its nodes in one allocation
+		const char* p = (h.count <= r.remaining() / sizeof(T)) ? r.take(h.count * sizeof(T)) : nullptr;
+		if(p == nullptr) return false;
+
+		list.assign(raw_element_iterator<T>(p), raw_element_iterator<T>(p + h.count * sizeof(T)));
+		return true;
+	}
+	else
+	{
+		for(std::uint64_t i = 0; i < h.count; ++i)
+		{
+			T v;
+			if(!traits::read(r, v))
+			{
+				list.clear();
+				return false;
+			}
+			list.push_back(std::move(v));
+		}
+		return true;
+	}
+}
+
+// load_binary(path, list)	//Replaces list with the snapshot in the file at path, read through a mapping.
+template<class T, class Alloc, bool Doubly>
+bool load_binary(const char* path, slist<T, Alloc, Doubly>& list)
+{
+	mapped_file file(path);
+	if(!file.is_open())
+	{
+		list.clear();
+		return false;
+	}
+	return load_binary(file.begin(), file.end(), list);
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef SLIST_PARALLEL_H
+#define SLIST_PARALLEL_H
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "slist.h"
+#include "worker_pool.h"
+
+// Parallel for_each, transform_reduce and count_if over an slist.
+//
+// A list can only be entered at its front, so the work is cut ahead of
+// time: list_segments walks the list once and keeps the iterator at every
+// cut, making segments of equal length from the O(1) size. The segments
+// then go to a worker_pool; each worker walks its own stretch of the list,
+// with no locks, and allocates nothing. There are several segments per
+// worker so that one slow segment does not hold up the rest.
+//
+// The cut points stay valid until the list's links change, so a list read
+// many times should keep its list_segments and pass them in, paying for
+// the serial cutting walk once rather than on every call.
+//
+// Reductions combine the segments' results in list order, so for a given
+// segment count the result does not depend on scheduling; the reduce
+// operation must be associative.
+
+// segments per worker when the caller does not choose
+constexpr std::size_t slist_segments_per_worker = 4;
+// fewest elements worth giving a segment of its own
+constexpr std::size_t slist_parallel_grain = 1 << 14;
+
+// Cut points of a list: segment i is [begin(i), end(i)). Iter is the
+// list's iterator or const_iterator, as the algorithms may write or not.
+template<class Iter>
+class list_segments
+{
+public:
+	typedef std::size_t size_type;
+
+	list_segments() {}
+
+	// cut [first, last), n elements long, into pieces runs whose lengths differ by at most one
+	list_segments(Iter first, Iter last, size_type n, size_type pieces);
+
+	// number of segments
+	size_type size() const { return bounds.empty() ? 0 : bounds.size() - 1; }
+
+	inline Iter begin(size_type i) const { return bounds[i]; }
+	inline Iter end(size_type i) const { return bounds[i + 1]; }
+
+private:
+	std::vector<Iter> bounds;
+};
+
+template<class Iter>
+list_segments<Iter>::list_segments(Iter first, Iter last, size_type n, size_type pieces)
+{
+	if(n == 0) return;
+	if(pieces == 0) pieces = 1;
+	if(pieces > n) pieces = n;
+
+	bounds.reserve(pieces + 1);
+	bounds.push_back(first);
+	for(size_type i = 0; i + 1 < pieces; ++i)
+	{
+		size_type len = n / pieces + (i < n % pieces ? 1 : 0);
+		while(len-- > 0) ++first;
+		bounds.push_back(first);
+	}
+	bounds.push_back(last);
+}
+
+namespace slist_parallel_detail
+{
+	// segments for n elements on pool: several per worker, none under the grain
+	inline std::size_t pieces(std::size_t n, const worker_pool& pool)
+	{
+		std::size_t k = pool.size() * slist_segments_per_worker;
+		std::size_t most = n / slist_parallel_grain;
+		if(k > most) k = most;
+		return k == 0 ? 1 : k;
+	}
+}
+
+// segments(list, pieces)	//Cuts a list into pieces balanced segments for the parallel algorithms.
+template<class T, class Alloc, bool Doubly>
+list_segments<typename slist<T, Alloc, Doubly>::const_iterator> segments(const slist<T, Alloc, Doubly>& list, std::size_t pieces)
+{
+	return list_segments<typename slist<T, Alloc, Doubly>::const_iterator>(
+		list.cbegin(), list.cend(), list.size(), pieces);
+}
+
+template<class T, class Alloc, bool Doubly>
+list_segments<typename slist<T, Alloc, Doubly>::iterator> segments(slist<T, Alloc, Doubly>& list, std::size_t pieces)
+{
+	return list_segments<typename slist<T, Alloc, Doubly>::iterator>(
+		list.begin(), list.end(), list.size(), pieces);
+}
+
+// parallel_for_each(segs, f, pool)	//Calls f on every element, one segment per task.
+template<class Iter, class F>
+void parallel_for_each(const list_segments<Iter>& segs, F f, worker_pool& pool = shared_pool())
+{
+	pool.run(segs.size(), [&](unsigned, std::size_t i)
+	{
+		for(Iter it = segs.begin(i), last = segs.end(i); it != last; ++it)
+			f(*it);
+	});
+}
+
+// parallel_transform_reduce(segs, init, reduce, transform, pool)	//Folds transform(x) over every element with reduce.
+template<class Iter, class R, class Reduce, class Transform>
+R parallel_transform_reduce(const list_segments<Iter>& segs, R init, Reduce reduce, Transform transform,
+	worker_pool& pool = shared_pool())
+{
+	if(segs.size() == 0) return init;
+
+	// each segment folds from its first element, so init is used only once
+	std::vector<R> partial(segs.size());
+	pool.run(segs.size(), [&](unsigned, std::size_t i)
+	{
+		Iter it = segs.begin(i), last = segs.end(i);
+		R acc = transform(*it);
+		for(++it; it != last; ++it)
+			acc = reduce(std::move(acc), transform(*it));
+		partial[i] = std::move(acc);
+	});
+
+	for(R& r: partial)
+		init = reduce(std::move(init), std::move(r));
+	return init;
+}
+
+// parallel_count_if(segs, pred, pool)	//Returns the number of elements pred accepts.
+template<class Iter, class Pred>
+std::size_t parallel_count_if(const list_segments<Iter>& segs, Pred pred, worker_pool& pool = shared_pool())
+{
+	return parallel_transform_reduce(segs, std::size_t(0),
+		[](std::size_t a, std::size_t b) { return a + b; },
+		[&pred](const typename std::iterator_traits<Iter>::value_type& v) { return std::size_t(pred(v) ? 1 : 0); },
+		pool);
+}
+
+// The same over a whole list, cut for the pool on every call.
+
+template<class T, class Alloc, bool Doubly, class F>
+void parallel_for_each(slist<T, Alloc, Doubly>& list, F f, worker_pool& pool = shared_pool())
+	{ parallel_for_each(segments(list, slist_parallel_detail::pieces(list.size(), pool)), f, pool); }
+
+template<class T, class Alloc, bool Doubly, class F>
+void parallel_for_each(const slist<T, Alloc, Doubly>& list, F f, worker_pool& pool = shared_pool())
+	{ parallel_for_each(segments(list, slist_parallel_detail::pieces(list.size(), pool)), f, pool); }
+
+template<class T, class Alloc, bool Doubly, class R, class Reduce, class Transform>
+R parallel_transform_reduce(const slist<T, Alloc, Doubly>& list, R init, Reduce reduce, Transform transform,
+	worker_pool& pool = shared_pool())
+{
+	return parallel_transform_reduce(segments(list, slist_parallel_detail::pieces(list.size(), pool)),
+		std::move(init), reduce, transform, pool);
+}
+
+template<class T, class Alloc, bool Doubly, class Pred>
+std::size_t parallel_count_if(const slist<T, Alloc, Doubly>& list, Pred pred, worker_pool& pool = shared_pool())
+	{ return parallel_count_if(segments(list, slist_parallel_detail::pieces(list.size(), pool)), pred, pool); }
+
+#endif
@@ -0,0 +1,922 @@
+#ifndef USLIST_H
+#define USLIST_H
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "compare.h"
+#include "format.h"
+#include "node_pool.h"
+
+// default elements per node: enough to fill roughly four cache lines
+template<class T>
+constexpr std::size_t uslist_capacity()
+{
+	return (256 - 3 * sizeof(void*)) / sizeof(T) > 4 ? (256 - 3 * sizeof(void*)) / sizeof(T) : 4;
+}
+
+// Unrolled variant of slist: each node holds up to N elements in a small
+// inline array, so a scan touches one node header per N elements instead
+// of one per element. Nodes sit on a circular sentinel ring like slist;
+// links go both ways so a node can be unlinked when it empties.
+//
+// Nodes split in half when an insert hits a full one, and a node that
+// falls under a quarter full after an erase absorbs its successor when
+// both fit. Every node in the ring holds at least one element.
+template<class T, std::size_t N = uslist_capacity<T>(), class Alloc = node_pool<T>>
+class uslist
+{
+	static_assert(N >= 2, "uslist needs room for at least two elements per node");
+
+	struct Link
+	{
+		Link* next;
+		Link* prev;
+	};
+
+	struct Node: Link
+	{
+		Node(Link* _next, Link* _prev):
+			Link{_next, _prev}, n(0) {}
+
+		inline T* at(std::size_t i)
+			{ return std::launder(reinterpret_cast<T*>(storage)) + i; }
+		inline const T* at(std::size_t i) const
+			{ return std::launder(reinterpret_cast<const T*>(storage)) + i; }
+
+		std::size_t n;
+		alignas(T) unsigned char storage[N * sizeof(T)];
+	};
+
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Alloc allocator_type;
+
+	static constexpr size_type node_capacity = N;
+
+private:
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> node_allocator;
+	typedef std::allocator_traits<node_allocator> node_traits;
+
+	// sentinel; head.next is the first node and head.prev the last
+	Link head;
+	// number of elements, kept current by every insert/erase
+	size_type count;
+	node_allocator alloc;
+
+	// allocate an empty node and link it in after pos
+	Node* create_node(Link* pos);
+	// unlink an empty node and hand its storage back
+	void destroy_node(Node*);
+
+	// move the upper half of a full node into a new node after it
+	Node* split(Node*);
+	// append next's elements to n and drop next
+	void absorb(Node* n, Node* next);
+	// construct a value at slot i of n, which has room for it
+	template<class... Args>
+	void place(Node* n, std::size_t i, Args&&... args);
+
+	// overwrite d's elements with s's, keeping d->n current if a copy throws
+	static void copy_elements(Node* d, const Node* s);
+	// make the nodes mirror other's, reusing the nodes already here
+	void copy_nodes(const uslist& other);
+
+	void steal(uslist& other) noexcept;
+
+	// the nodes as runs of adjacent elements, for compare.h
+	struct runs
+	{
+		explicit runs(const Link* _head):
+			head(_head), cur(_head), p(nullptr), e(nullptr) {}
+
+		bool next()
+		{
+			cur = cur->next;
+			if(cur == head) return false;
+			const Node* n = static_cast<const Node*>(cur);
+			p = n->at(0);
+			e = n->at(n->n);
+			return true;
+		}
+
+		const Link* head;
+		const Link* cur;
+		const T* p;
+		const T* e;
+	};
+
+public:
+	class iterator;
+	class const_iterator;
+
+	uslist();
+	explicit uslist(const Alloc& a);
+	uslist(const uslist& other);
+	uslist(uslist&& other) noexcept;
+
+	uslist& operator=(const uslist& other);
+	uslist& operator=(uslist&& other);
+
+	template<class E, std::size_t M, class A>
+	friend bool operator==(const uslist<E, M, A>&, const uslist<E, M, A>&);
+	template<class E, std::size_t M, class A>
+	friend bool operator!=(const uslist<E, M, A>&, const uslist<E, M, A>&);
+	template<class E, std::size_t M, class A>
+	friend std::ostream& operator<<(std::ostream& os, const uslist<E, M, A>& u_l);
+
+	// return true if empty
+	bool empty() const;
+
+	// return size of list
+	size_type size() const;
+
+	// lexicographic order: <0, 0 or >0 as this list sorts before, with or after other
+	int compare(const uslist&) const;
+
+	// hash of the elements in order; lists that compare equal hash alike
+	std::size_t hash() const;
+
+	// clear list
+	void clear();
+
+	// append element to end of list
+	void push_back(const T&);
+	void push_back(T&&);
+
+	// erase last element in list
+	void pop_back();
+
+	// insert element at front of list
+	void push_front(const T&);
+	void push_front(T&&);
+
+	// erase first element in list
+	void pop_front();
+
+	// construct element in place at front / end / position
+	template<class... Args>
+	reference emplace_front(Args&&...);
+	template<class... Args>
+	reference emplace_back(Args&&...);
+	template<class... Args>
+	iterator emplace(const const_iterator&, Args&&...);
+
+	// insert element before position
+	iterator insert(const const_iterator&, const T&);
+	iterator insert(const const_iterator&, T&&);
+
+	// erase element at position / in range; returns the element after
+	iterator erase(const const_iterator&);
+	iterator erase(const_iterator, const const_iterator&);
+
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+
+	iterator end();
+	const_iterator end() const;
+	const_iterator cend() const;
+
+	reference front();
+	const_reference front() const;
+
+	reference back();
+	const_reference back() const;
+
+	// convert to string
+	std::string to_string() const;
+
+	// destroy
+	~uslist();
+};
+
+// Iterators address an element as (node, index); end() is (sentinel, 0).
+template<class T, std::size_t N, class Alloc>
+class uslist<T, N, Alloc>::const_iterator
+{
+	friend class uslist;
+	friend class iterator;
+
+public:
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	const_iterator(const Link* _ref = nullptr, std::size_t _idx = 0):
+		ref(_ref), idx(_idx) {}
+	const_iterator(const iterator& other):
+		ref(other.ref), idx(other.idx) {}
+
+	inline bool operator==(const const_iterator& rhs) const
+		{ return ref == rhs.ref && idx == rhs.idx; }
+	inline bool operator!=(const const_iterator& rhs) const
+		{ return !(*this == rhs); }
+
+	inline const_iterator& operator++()
+	{
+		if(++idx == static_cast<const Node*>(ref)->n)
+		{
+			ref = ref->next;
+			idx = 0;
+		}
+		return *this;
+	}
+	inline const_iterator operator++(int)
+	{
+		const_iterator tmp(*this);
+		++*this;
+		return tmp;
+	}
+
+	inline const_iterator& operator--()
+	{
+		if(idx == 0)
+		{
+			ref = ref->prev;
+			idx = static_cast<const Node*>(ref)->n;
+		}
+		--idx;
+		return *this;
+	}
+	inline const_iterator operator--(int)
+	{
+		const_iterator tmp(*this);
+		--*this;
+		return tmp;
+	}
+
+	inline reference operator*() const
+		{ return *static_cast<const Node*>(ref)->at(idx); }
+	inline pointer operator->() const
+		{ return static_cast<const Node*>(ref)->at(idx); }
+
+private:
+	const Link* ref;
+	std::size_t idx;
+};
+
+template<class T, std::size_t N, class Alloc>
+class uslist<T, N, Alloc>::iterator
+{
+	friend class uslist;
+	friend class const_iterator;
+
+public:
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	iterator(Link* _ref = nullptr, std::size_t _idx = 0):
+		ref(_ref), idx(_idx) {}
+
+	inline bool operator==(const iterator& rhs) const
+		{ return ref == rhs.ref && idx == rhs.idx; }
+	inline bool operator!=(const iterator& rhs) const
+		{ return !(*this == rhs); }
+
+	inline iterator& operator++()
+	{
+		if(++idx == static_cast<Node*>(ref)->n)
+		{
+			ref = ref->next;
+			idx = 0;
+		}
+		return *this;
+	}
+	inline iterator operator++(int)
+	{
+		iterator tmp(*this);
+		++*this;
+		return tmp;
+	}
+
+	inline iterator& operator--()
+	{
+		if(idx == 0)
+		{
+			ref = ref->prev;
+			idx = static_cast<Node*>(ref)->n;
+		}
+		--idx;
+		return *this;
+	}
+	inline iterator operator--(int)
+	{
+		iterator tmp(*this);
+		--*this;
+		return tmp;
+	}
+
+	inline reference operator*() const
+		{ return *static_cast<Node*>(ref)->at(idx); }
+	inline pointer operator->() const
+		{ return static_cast<Node*>(ref)->at(idx); }
+
+private:
+	Link* ref;
+	std::size_t idx;
+};
+
+// node boundaries need not line up: the walk compares the overlap of the
+// two current nodes, a block at a time when elements compare bytewise
+template<class T, std::size_t N, class Alloc>
+inline bool operator==(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+{
+	typedef typename uslist<T, N, Alloc>::runs runs;
+	return lhs.size() == rhs.size() && equal_runs(runs(&lhs.head), runs(&rhs.head));
+}
+
+template<class T, std::size_t N, class Alloc>
+inline bool operator!=(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+	{ return !(lhs == rhs); }
+
+template<class T, std::size_t N, class Alloc>
+inline bool operator<(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+	{ return lhs.compare(rhs) < 0; }
+
+template<class T, std::size_t N, class Alloc>
+inline bool operator<=(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+	{ return lhs.compare(rhs) <= 0; }
+
+template<class T, std::size_t N, class Alloc>
+inline bool operator>(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+	{ return lhs.compare(rhs) > 0; }
+
+template<class T, std::size_t N, class Alloc>
+inline bool operator>=(const uslist<T, N, Alloc>& lhs, const uslist<T, N, Alloc>& rhs)
+	{ return lhs.compare(rhs) >= 0; }
+
+namespace std
+{
+	template<class T, std::size_t N, class Alloc>
+	struct hash<uslist<T, N, Alloc>>
+	{
+		std::size_t operator()(const uslist<T, N, Alloc>& u_l) const
+			{ return u_l.hash(); }
+	};
+}
+
+template<class T, std::size_t N, class Alloc>
+inline std::ostream& operator<<(std::ostream& os, const uslist<T, N, Alloc>& u_l)
+	{ return format_stream(os, u_l.cbegin(), u_l.cend()); }
+
+// Constructor
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>::uslist():
+	head{&head, &head}, count(0), alloc() {}
+
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>::uslist(const Alloc& a):
+	head{&head, &head}, count(0), alloc(a) {}
+
+// copy constructor; the copy has the same node layout as the source
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>::uslist(const uslist& other):
+	head{&head, &head}, count(0),
+	alloc(node_traits::select_on_container_copy_construction(other.alloc))
+{
+	copy_nodes(other);
+}
+
+// move constructor
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>::uslist(uslist&& other) noexcept:
+	head{&head, &head}, count(0), alloc(std::move(other.alloc))
+{
+	steal(other);
+}
+
+// assignment operator
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>& uslist<T, N, Alloc>::operator=(const uslist& other)
+{
+	if(this == &other) return *this;
+
+	if constexpr(node_traits::propagate_on_container_copy_assignment::value)
+	{
+		// nodes from the old allocator cannot outlive it
+		if(alloc != other.alloc)
+		{
+			clear();
+			alloc = other.alloc;
+		}
+	}
+	copy_nodes(other);
+	return *this;
+}
+
+template<class T, std::size_t N, class Alloc>
+uslist<T, N, Alloc>& uslist<T, N, Alloc>::operator=(uslist&& other)
+{
+	if(this == &other) return *this;
+
+	clear();
+	if constexpr(node_traits::propagate_on_container_move_assignment::value)
+	{
+		alloc = std::move(other.alloc);
+		steal(other);
+	}
+	else
+	{
+		if(alloc == other.alloc)
+		{
+			steal(other);
+		}
+		else
+		{
+			for(iterator it = other.begin(); it != other.end(); ++it)
+				emplace_back(std::move(*it));
+			other.clear();
+		}
+	}
+	return *this;
+}
+
+// Destructor
+template<class T, std::size_t N, class Alloc>
+inline uslist<T, N, Alloc>::~uslist()
+	{ clear(); }
+
+// steal(other)				//relinks other's nodes behind this sentinel in O(1)
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::steal(uslist& other) noexcept
+{
+	if(other.empty()) return;
+
+	head.next = other.head.next;
+	head.prev = other.head.prev;
+	head.next->prev = &head;
+	head.prev->next = &head;
+	count = other.count;
+
+	other.head.next = other.head.prev = &other.head;
+	other.count = 0;
+}
+
+// create_node(pos)			//links a new, empty node in after pos
+template<class T, std::size_t N, class Alloc>
+typename uslist<T, N, Alloc>::Node* uslist<T, N, Alloc>::create_node(Link* pos)
+{
+	Node* n = node_traits::allocate(alloc, 1);
+	::new(static_cast<void*>(n)) Node(pos->next, pos);
+	pos->next->prev = n;
+	pos->next = n;
+	return n;
+}
+
+// destroy_node(node)		//unlinks an empty node and frees it
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::destroy_node(Node* n)
+{
+	n->prev->next = n->next;
+	n->next->prev = n->prev;
+	n->~Node();
+	node_traits::deallocate(alloc, n, 1);
+}
+
+// copy_elements(d, s)		//overwrites d's elements with s's
+template<class T, std::size_t N, class Alloc>
+void uslist<T, N, Alloc>::copy_elements(Node* d, const Node* s)
+{
+	if constexpr(std::is_trivially_copyable<T>::value)
+	{
+		// the old elements need no destructor and the new ones are their bytes
+		if(s->n > 0) std::memcpy(static_cast<void*>(d->storage), s->storage, s->n * sizeof(T));
+		d->n = s->n;
+	}
+	else
+	{
+		std::size_t i = 0;
+		const std::size_t live = d->n < s->n ? d->n : s->n;
+		for(; i < live; ++i)
+			*d->at(i) = *s->at(i);
+		for(; i < s->n; ++i)
+		{
+			::new(static_cast<void*>(d->at(i))) T(*s->at(i));
+			d->n = i + 1;
+		}
+		for(; i < d->n; ++i)
+			d->at(i)->~T();
+		d->n = s->n;
+	}
+}
+
+// copy_nodes(other)		//gives this list other's elements in other's node layout
+template<class T, std::size_t N, class Alloc>
+void uslist<T, N, Alloc>::copy_nodes(const uslist& other)
+{
+	if(other.count == 0)
+	{
+		clear();
+		return;
+	}
+
+	// overwrite the nodes already here; a list of the same shape never allocates
+	Link* d = head.next;
+	const Link* s = other.head.next;
+	for(; d != &head && s != &other.head; d = d->next, s = s->next)
+	{
+		Node* n = static_cast<Node*>(d);
+		count -= n->n;
+		try
+		{
+			copy_elements(n, static_cast<const Node*>(s));
+		}
+		catch(...)
+		{
+			count += n->n;
+			throw;
+		}
+		count += n->n;
+	}
+
+	// drop the nodes left over
+	while(d != &head)
+	{
+		Node* n = static_cast<Node*>(d);
+		d = d->next;
+		if constexpr(!std::is_trivially_destructible<T>::value)
+		{
+			for(std::size_t i = 0; i < n->n; ++i)
+				n->at(i)->~T();
+		}
+		count -= n->n;
+		n->n = 0;
+		destroy_node(n);
+	}
+
+	// or add the nodes still missing, all from one allocation when the
+	// pool can free them one at a time
+	size_type missing = 0;
+	for(const Link* l = s; l != &other.head; l = l->next) ++missing;
+	if(missing == 0) return;
+
+	Node* block = nullptr;
+	if constexpr(frees_singly<node_allocator>::value)
+		block = node_traits::allocate(alloc, missing);
+
+	for(size_type i = 0; s != &other.head; s = s->next, ++i)
+	{
+		Node* n = block != nullptr ? block + i : node_traits::allocate(alloc, 1);
+		::new(static_cast<void*>(n)) Node(&head, head.prev);
+		try
+		{
+			copy_elements(n, static_cast<const Node*>(s));
+		}
+		catch(...)
+		{
+			// a node joins the ring only once its elements are in, so nothing else to undo
+			for(std::size_t j = 0; j < n->n; ++j)
+				n->at(j)->~T();
+			n->~Node();
+			if(block == nullptr)
+				node_traits::deallocate(alloc, n, 1);
+			else
+				for(size_type j = i; j < missing; ++j)
+					node_traits::deallocate(alloc, block + j, 1);
+			throw;
+		}
+		head.prev->next = n;
+		head.prev = n;
+		count += n->n;
+	}
+}
+
+// split(node)				//moves the upper half of a full node into a new node after it
+template<class T, std::size_t N, class Alloc>
+typename uslist<T, N, Alloc>::Node* uslist<T, N, Alloc>::split(Node* n)
+{
+	Node* upper = create_node(n);
+	const std::size_t keep = n->n / 2;
+
+	for(std::size_t i = keep; i < n->n; ++i)
+	{
+		::new(static_cast<void*>(upper->at(i - keep))) T(std::move(*n->at(i)));
+		n->at(i)->~T();
+	}
+	upper->n = n->n - keep;
+	n->n = keep;
+
+	return upper;
+}
+
+// absorb(node, next)		//appends next's elements to node and drops next
+template<class T, std::size_t N, class Alloc>
+void uslist<T, N, Alloc>::absorb(Node* n, Node* next)
+{
+	for(std::size_t i = 0; i < next->n; ++i)
+	{
+		::new(static_cast<void*>(n->at(n->n + i))) T(std::move(*next->at(i)));
+		next->at(i)->~T();
+	}
+	n->n += next->n;
+	next->n = 0;
+	destroy_node(next);
+}
+
+// push_back(value)			//adds a new value to the end of this list.
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::push_back(const T& data)
+	{ emplace(cend(), data); }
+
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::push_back(T&& data)
+	{ emplace(cend(), std::move(data)); }
+
+// pop_back() 				//erase value at end of list
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::pop_back()
+	{ erase(--cend()); }
+
+// push_front(value)		//adds a new value to the start of this list
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::push_front(const T& data)
+	{ emplace(cbegin(), data); }
+
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::push_front(T&& data)
+	{ emplace(cbegin(), std::move(data)); }
+
+// pop_front()				//erase value at front of list
+template<class T, std::size_t N, class Alloc>
+inline void uslist<T, N, Alloc>::pop_front()
+	{ erase(cbegin()); }
+
+template<class T, std::size_t N, class Alloc>
+template<class... Args>
+inline typename uslist<T, N, Alloc>::reference uslist<T, N, Alloc>::emplace_front(Args&&... args)
+	{ return *emplace(cbegin(), std::forward<Args>(args)...); }
+
+template<class T, std::size_t N, class Alloc>
+template<class... Args>
+inline typename uslist<T, N, Alloc>::reference uslist<T, N, Alloc>::emplace_back(Args&&... args)
+	{ return *emplace(cend(), std::forward<Args>(args)...); }
+
+// emplace(index, args...)	//constructs a new value in place before the specified index.
+template<class T, std::size_t N, class Alloc>
+template<class... Args>
+typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::emplace(const const_iterator& pos, Args&&... args)
+{
+	Link* l = const_cast<Link*>(pos.ref);
+	std::size_t i = pos.idx;
+	Node* n;
+
+	if(l == &head)
+	{
+		// appending: fill the last node, start a new one when it is full
+		if(head.prev == &head || static_cast<Node*>(head.prev)->n == N)
+			n = create_node(head.prev);
+		else
+			n = static_cast<Node*>(head.prev);
+		i = n->n;
+	}
+	else
+	{
+		n = static_cast<Node*>(l);
+		if(n->n == N)
+		{
+			if(i == 0)
+			{
+				// prepending to a full node: start a fresh node in front of it
+				n = create_node(n->prev);
+			}
+			else
+			{
+				// build the value before split() moves elements args may refer to
+				T tmp(std::forward<Args>(args)...);
+				Node* upper = split(n);
+				if(i > n->n)
+				{
+					i -= n->n;
+					n = upper;
+				}
+				place(n, i, std::move(tmp));
+				return iterator(n, i);
+			}
+		}
+	}
+
+	place(n, i, std::forward<Args>(args)...);
+	return iterator(n, i);
+}
+
+// place(node, i, args...)	//constructs a value at slot i of a node with room, moving later elements up
+template<class T, std::size_t N, class Alloc>
+template<class... Args>
+void uslist<T, N, Alloc>::place(Node* n, std::size_t i, Args&&... args)
+{
+	if(i == n->n)
+	{
+		try
+		{
+			::new(static_cast<void*>(n->at(i))) T(std::forward<Args>(args)...);
+		}
+		catch(...)
+		{
+			// a node created for this value must not stay in the ring empty
+			if(n->n == 0) destroy_node(n);
+			throw;
+		}
+	}
+	else
+	{
+		// build the value first so a throwing constructor leaves the node intact
+		T tmp(std::forward<Args>(args)...);
+		::new(static_cast<void*>(n->at(n->n))) T(std::move(*n->at(n->n - 1)));
+		for(std::size_t j = n->n - 1; j > i; --j)
+			*n->at(j) = std::move(*n->at(j - 1));
+		*n->at(i) = std::move(tmp);
+	}
+	++n->n;
+	++count;
+}
+
+//insert(value, index)		//Inserts the element into this list before the specified index.
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::insert(const const_iterator& pos, const T& data)
+	{ return emplace(pos, data); }
+
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::insert(const const_iterator& pos, T&& data)
+	{ return emplace(pos, std::move(data)); }
+
+// erase(index)				//erases the element at the specified index from this list.
+template<class T, std::size_t N, class Alloc>
+typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::erase(const const_iterator& pos)
+{
+	Node* n = static_cast<Node*>(const_cast<Link*>(pos.ref));
+	std::size_t i = pos.idx;
+
+	for(std::size_t j = i + 1; j < n->n; ++j)
+		*n->at(j - 1) = std::move(*n->at(j));
+	n->at(n->n - 1)->~T();
+	--n->n;
+	--count;
+
+	if(n->n == 0)
+	{
+		Link* next = n->next;
+		destroy_node(n);
+		return iterator(next, 0);
+	}
+
+	// keep nodes reasonably full: an underfull node takes in its successor
+	if(n->n < N / 4 && n->next != &head)
+	{
+		Node* next = static_cast<Node*>(n->next);
+		if(n->n + next->n <= N)
+			absorb(n, next);
+	}
+
+	if(i < n->n) return iterator(n, i);
+	return iterator(n->next, 0);
+}
+
+template<class T, std::size_t N, class Alloc>
+typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::erase(const_iterator first, const const_iterator& last)
+{
+	size_type n = 0;
+	for(const_iterator it = first; it != last; ++it) ++n;
+
+	iterator it(const_cast<Link*>(first.ref), first.idx);
+	while(n--)
+		it = erase(it);
+	return it;
+}
+
+// clear()					//erases all elements from this list.
+template<class T, std::size_t N, class Alloc>
+void uslist<T, N, Alloc>::clear()
+{
+	size_type nodes = 0;
+	for(Link* l = head.next; l != &head; l = l->next)
+	{
+		Node* n = static_cast<Node*>(l);
+		if constexpr(!std::is_trivially_destructible<T>::value)
+		{
+			for(std::size_t i = 0; i < n->n; ++i)
+				n->at(i)->~T();
+		}
+		n->n = 0;
+		++nodes;
+	}
+
+	bool released = false;
+	if constexpr(is_releasable<node_allocator>::value)
+	{
+		// when every outstanding node is ours the pool drops its slabs at once
+		if(alloc.outstanding() == nodes)
+		{
+			alloc.release();
+			released = true;
+		}
+	}
+	if(!released)
+	{
+		while(head.next != &head)
+			destroy_node(static_cast<Node*>(head.next));
+	}
+
+	head.next = head.prev = &head;
+	count = 0;
+}
+
+// empty()					//Returns true if this list contains no elements.
+template<class T, std::size_t N, class Alloc>
+inline bool uslist<T, N, Alloc>::empty() const
+	{ return count == 0; }
+
+// size()					//Returns the number of elements in this list.
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::size_type uslist<T, N, Alloc>::size() const
+	{ return count; }
+
+// compare(list)			//Orders two lists by their first differing element, then by length.
+template<class T, std::size_t N, class Alloc>
+inline int uslist<T, N, Alloc>::compare(const uslist& other) const
+	{ return compare_runs(runs(&head), runs(&other.head)); }
+
+// hash()					//Returns a hash of the elements in order.
+template<class T, std::size_t N, class Alloc>
+std::size_t uslist<T, N, Alloc>::hash() const
+{
+	sequence_hash<T> h;
+	for(const Link* l = head.next; l != &head; l = l->next)
+	{
+		const Node* n = static_cast<const Node*>(l);
+		h.add(n->at(0), n->n);
+	}
+	return h.value();
+}
+
+//begin()					//returns iterator to first element
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::begin()
+	{ return iterator(head.next, 0); }
+
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_iterator uslist<T, N, Alloc>::begin() const
+	{ return const_iterator(head.next, 0); }
+
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_iterator uslist<T, N, Alloc>::cbegin() const
+	{ return const_iterator(head.next, 0); }
+
+//end() 					//returns iterator past the last element
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::iterator uslist<T, N, Alloc>::end()
+	{ return iterator(&head, 0); }
+
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_iterator uslist<T, N, Alloc>::end() const
+	{ return const_iterator(&head, 0); }
+
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_iterator uslist<T, N, Alloc>::cend() const
+	{ return const_iterator(&head, 0); }
+
+//front() 					//returns element at front of list
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::reference uslist<T, N, Alloc>::front()
+	{ return *static_cast<Node*>(head.next)->at(0); }
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_reference uslist<T, N, Alloc>::front() const
+	{ return *static_cast<const Node*>(head.next)->at(0); }
+
+//back()					//returns element at end of list
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::reference uslist<T, N, Alloc>::back()
+{
+	Node* n = static_cast<Node*>(head.prev);
+	return *n->at(n->n - 1);
+}
+template<class T, std::size_t N, class Alloc>
+inline typename uslist<T, N, Alloc>::const_reference uslist<T, N, Alloc>::back() const
+{
+	const Node* n = static_cast<const Node*>(head.prev);
+	return *n->at(n->n - 1);
+}
+
+// toString()				//Converts the list to a printable string representation.
+template<class T, std::size_t N, class Alloc>
+std::string uslist<T, N, Alloc>::to_string() const
+	{ return format_string(cbegin(), cend()); }
+
+#endif
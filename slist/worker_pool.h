@@ -0,0 +1,168 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that sleep between jobs. A job is a count of
+// tasks and a function run as f(worker, task); workers claim tasks from a
+// shared counter, the calling thread works alongside them as worker 0, and
+// run() returns once every task is done. Handing a job over costs one
+// wake-up and allocates nothing, so it pays off for jobs of a few
+// milliseconds, where starting threads per call would not.
+//
+// One job runs at a time. A run() that finds the pool busy, whether from
+// another thread or from inside a task, does its tasks on the calling
+// thread instead of waiting, so nested parallel calls cannot deadlock.
+class worker_pool
+{
+public:
+	// threads counts the caller; 0 means one per hardware thread
+	explicit worker_pool(unsigned threads = 0);
+	~worker_pool();
+
+	worker_pool(const worker_pool&) = delete;
+	worker_pool& operator=(const worker_pool&) = delete;
+
+	// workers taking part in a job, the caller included
+	unsigned size() const { return unsigned(threads.size()) + 1; }
+
+	// runs f(worker, task) for every task in [0, tasks); the first exception
+	// a task throws stops the claiming of new tasks and is rethrown here
+	template<class F>
+	void run(std::size_t tasks, F f);
+
+private:
+	// the job, type-erased without allocating: fn calls ctx's function
+	struct job
+	{
+		void (*fn)(void*, unsigned, std::size_t);
+		void* ctx;
+		std::size_t tasks;
+	};
+
+	void loop(unsigned worker);
+	void work(unsigned worker);
+
+	std::vector<std::thread> threads;
+	// serializes jobs; try-locked, so a busy pool runs the caller's job inline
+	std::mutex busy;
+	std::mutex m;
+	std::condition_variable wake;
+	std::condition_variable done;
+	job current;
+	std::atomic<std::size_t> next;
+	// workers still on the current job
+	unsigned active;
+	std::uint64_t generation;
+	bool stop;
+	std::exception_ptr error;
+};
+
+inline worker_pool::worker_pool(unsigned n):
+	current{nullptr, nullptr, 0}, next(0), active(0), generation(0), stop(false)
+{
+	if(n == 0) n = std::thread::hardware_concurrency();
+	if(n == 0) n = 1;
+	threads.reserve(n - 1);
+	for(unsigned w = 1; w < n; ++w)
+		threads.emplace_back(&worker_pool::loop, this, w);
+}
+
+inline worker_pool::~worker_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m);
+		stop = true;
+	}
+	wake.notify_all();
+	for(std::thread& t: threads) t.join();
+}
+
+// run(tasks, f)			//Runs f(worker, task) over [0, tasks) on every worker; returns when all are done.
+template<class F>
+void worker_pool::run(std::size_t tasks, F f)
+{
+	std::unique_lock<std::mutex> own(busy, std::try_to_lock);
+	if(!own.owns_lock() || threads.empty() || tasks < 2)
+	{
+		for(std::size_t t = 0; t < tasks; ++t) f(0, t);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m);
+		current = job{ [](void* ctx, unsigned w, std::size_t t) { (*static_cast<F*>(ctx))(w, t); }, &f, tasks };
+		next.store(0, std::memory_order_relaxed);
+		active = unsigned(threads.size());
+		error = nullptr;
+		++generation;
+	}
+	wake.notify_all();
+
+	work(0);
+
+	std::unique_lock<std::mutex> lock(m);
+	done.wait(lock, [this] { return active == 0; });
+	if(error)
+	{
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+}
+
+// work(worker)				//Claims and runs tasks of the current job until none are left.
+inline void worker_pool::work(unsigned w)
+{
+	const job j = current;
+	for(std::size_t t = next.fetch_add(1, std::memory_order_relaxed); t < j.tasks;
+		t = next.fetch_add(1, std::memory_order_relaxed))
+	{
+		try
+		{
+			j.fn(j.ctx, w, t);
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(m);
+			if(!error) error = std::current_exception();
+			next.store(j.tasks, std::memory_order_relaxed);
+		}
+	}
+}
+
+// loop(worker)				//A worker thread: sleeps until a new job or shutdown.
+inline void worker_pool::loop(unsigned w)
+{
+	std::uint64_t seen = 0;
+	for(;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m);
+			wake.wait(lock, [&] { return stop || generation != seen; });
+			if(stop) return;
+			seen = generation;
+		}
+
+		work(w);
+
+		std::lock_guard<std::mutex> lock(m);
+		if(--active == 0) done.notify_one();
+	}
+}
+
+// shared_pool()			//The process-wide pool, one worker per hardware thread, started on first use.
+inline worker_pool& shared_pool()
+{
+	static worker_pool pool;
+	return pool;
+}
+
+#endif